@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+#include "mem_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Double-buffered allocator for per-frame temporary data.
+ *
+ * Holds two MemZones (one for the current frame, one for the previous). Every call to
+ * 'frame_allocator_flip' frees the oldest one and starts using it for the new frame, so data
+ * allocated on a frame is still valid during the next one.
+ */
+typedef struct {
+	/// Zones used by the frames. The one not being used holds the data of the previous frame.
+	MemZone zones[2];
+	/// Index of the zone used by the current frame.
+	uint8_t current;
+} FrameAllocator;
+
+/**
+ * @brief Allocates and initializes a FrameAllocator.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate the FrameAllocator and both halves. If NULL will use 'malloc',
+ * in that case remember to call 'frame_allocator_destroy'.
+ * @param size_per_frame
+ *        Size in bytes available on each frame. Total memory used is twice this value.
+ *
+ * @return The new FrameAllocator.
+ */
+FrameAllocator *frame_allocator_init(MemZone *memory_pool, size_t size_per_frame);
+
+/**
+ * @brief Allocates memory that will be valid during this frame and the next one.
+ *
+ * @param frame_allocator
+ *        FrameAllocator to use.
+ * @param size
+ *        Size in bytes of the memory. (eg.: sizeof(int))
+ *
+ * @return the memory allocated, or NULL if there's no space left on this frame.
+ */
+void *frame_allocator_alloc(FrameAllocator *frame_allocator, size_t size);
+
+/**
+ * @brief Starts a new frame. Frees the data allocated two frames ago. Called by
+ * 'scene_manager_tick' if the FrameAllocator is set on the Scene Manager.
+ *
+ * @param frame_allocator
+ *        FrameAllocator to flip.
+ */
+void frame_allocator_flip(FrameAllocator *frame_allocator);
+
+/**
+ * @brief Frees the data of both the current and the previous frame.
+ *
+ * @param frame_allocator
+ *        FrameAllocator to reset.
+ */
+void frame_allocator_reset(FrameAllocator *frame_allocator);
+
+/**
+ * @brief Destroy a FrameAllocator created when not using a memory pool. Do not call this function
+ * if using a memory pool.
+ *
+ * @param frame_allocator
+ *        FrameAllocator to destroy.
+ */
+void frame_allocator_destroy(FrameAllocator *frame_allocator);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
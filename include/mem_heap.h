@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdint.h>
+#include "mem_pool.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Log2 of the amount of second-level lists for each first-level list.
+#define MEM_HEAP_SL_INDEX_COUNT_LOG2 4
+/// Amount of second-level lists for each first-level list.
+#define MEM_HEAP_SL_INDEX_COUNT (1 << MEM_HEAP_SL_INDEX_COUNT_LOG2)
+/// Log2 of the alignment of every allocation.
+#define MEM_HEAP_ALIGN_LOG2 4
+/// Blocks smaller than this are all kept on the first first-level list.
+#define MEM_HEAP_FL_INDEX_SHIFT (MEM_HEAP_SL_INDEX_COUNT_LOG2 + MEM_HEAP_ALIGN_LOG2)
+/// Log2 of the size limit of a block (blocks have to be smaller than 16MB).
+#define MEM_HEAP_FL_INDEX_MAX 24
+/// Amount of first-level lists.
+#define MEM_HEAP_FL_INDEX_COUNT (MEM_HEAP_FL_INDEX_MAX - MEM_HEAP_FL_INDEX_SHIFT + 1)
+
+/**
+ * @brief Header of a block of the heap. The memory of the block starts 16 bytes after the header
+ * start, so the free list pointers can share space with it (they're only used on free blocks).
+ */
+typedef struct MemHeapBlock {
+	/// Block right before this one in memory. NULL for the first block.
+	struct MemHeapBlock *prev_phys;
+	/// Size in bytes of the block, without the header. The lowest bit is set if the block is free.
+	size_t size;
+	/// Next free block on the same list. Only valid if the block is free.
+	struct MemHeapBlock *next_free;
+	/// Previous free block on the same list. Only valid if the block is free.
+	struct MemHeapBlock *prev_free;
+} MemHeapBlock;
+
+/**
+ * @brief General purpose heap using a Two-Level Segregated Fit allocator. Allocating and freeing
+ * are O(1), and free blocks are merged with their neighbors.
+ *
+ * Use it for data that doesn't live for a whole scene (MemZone) and doesn't have a fixed size
+ * (object pools), like assets that are loaded and unloaded during gameplay.
+ */
+typedef struct {
+	/// Start of the memory managed by the heap.
+	char *start;
+	/// End of the memory managed by the heap.
+	char *end;
+	/// Bitmap of the first-level lists that have free blocks.
+	uint32_t fl_bitmap;
+	/// Bitmaps of the second-level lists that have free blocks.
+	uint32_t sl_bitmap[MEM_HEAP_FL_INDEX_COUNT];
+	/// Free blocks of each list.
+	MemHeapBlock *blocks[MEM_HEAP_FL_INDEX_COUNT][MEM_HEAP_SL_INDEX_COUNT];
+	/// Bytes currently allocated (without headers).
+	size_t used_bytes;
+	/// Amount of allocations currently alive.
+	size_t alloc_count;
+} MemHeap;
+
+/**
+ * @brief Fragmentation info of the heap, filled by 'mem_heap_get_stats'.
+ */
+typedef struct {
+	/// Bytes currently allocated (without headers).
+	size_t used_bytes;
+	/// Bytes available on free blocks.
+	size_t free_bytes;
+	/// Size in bytes of the biggest free block.
+	size_t largest_free_block;
+	/// Size in bytes of the biggest allocation that can be done. Smaller than 'largest_free_block'
+	/// when that block is not at the start of its size class, since requests are rounded up.
+	size_t largest_alloc;
+	/// Amount of free blocks.
+	size_t free_block_count;
+	/// Amount of allocations currently alive.
+	size_t alloc_count;
+	/// From 0 (all free memory is in a single block) to 1 (free memory is spread in tiny blocks).
+	float fragmentation;
+} MemHeapStats;
+
+/**
+ * @brief Allocates and initializes a MemHeap.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate the heap and its memory. If NULL will use 'malloc', in that
+ * case remember to call 'mem_heap_destroy'.
+ * @param size
+ *        Size in bytes of the memory managed by the heap.
+ *
+ * @return The new MemHeap.
+ */
+MemHeap *mem_heap_init(MemZone *memory_pool, size_t size);
+
+/**
+ * @brief Allocates memory from the heap. The memory is aligned to 16 bytes.
+ *
+ * @param heap
+ *        MemHeap to use.
+ * @param size
+ *        Size in bytes of the memory. (eg.: sizeof(int))
+ *
+ * @return the memory allocated, or NULL if there's no free block big enough.
+ */
+void *mem_heap_alloc(MemHeap *heap, size_t size);
+
+/**
+ * @brief Returns memory to the heap.
+ *
+ * @param heap
+ *        MemHeap used to allocate 'ptr'.
+ * @param ptr
+ *        Memory returned by 'mem_heap_alloc' or 'mem_heap_realloc'. Can be NULL.
+ */
+void mem_heap_free(MemHeap *heap, void *ptr);
+
+/**
+ * @brief Changes the size of memory allocated from the heap. Tries to grow or shrink it in place
+ * before moving it.
+ *
+ * @param heap
+ *        MemHeap used to allocate 'ptr'.
+ * @param ptr
+ *        Memory to resize. If NULL works like 'mem_heap_alloc'.
+ * @param size
+ *        New size in bytes. If zero works like 'mem_heap_free'.
+ *
+ * @return the memory resized (can be different from 'ptr'), or NULL if there's no free block big
+ * enough (in that case 'ptr' is still valid).
+ */
+void *mem_heap_realloc(MemHeap *heap, void *ptr, size_t size);
+
+/**
+ * @brief Walks the heap to get fragmentation info. This is O(n), so avoid calling it every frame.
+ *
+ * @param heap
+ *        MemHeap to check.
+ * @param stats
+ *        Filled with the info of the heap.
+ */
+void mem_heap_get_stats(MemHeap *heap, MemHeapStats *stats);
+
+/**
+ * @brief Destroy a MemHeap created when not using a memory pool. Do not call this function if
+ * using a memory pool.
+ *
+ * @param heap
+ *        MemHeap to destroy.
+ */
+void mem_heap_destroy(MemHeap *heap);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -1,24 +1,177 @@
 #pragma once
 
 #include <malloc.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Define MEM_ZONE_STATS (for the whole project, as it changes the size of MemZone) to keep track of
+ * how each MemZone is being used. See 'MemZoneStats'.
+ */
+#ifdef MEM_ZONE_STATS
+#ifndef MEM_ZONE_STATS_MAX_TAGS
+/// Amount of tags tracked by 'mem_zone_alloc_tagged'.
+#define MEM_ZONE_STATS_MAX_TAGS 16
+#endif
+
 /**
- * @brief A contiguous zone where memory can be allocated.
+ * @brief Usage of a MemZone. Only available when MEM_ZONE_STATS is defined.
  */
 typedef struct {
+	/// Bytes currently allocated (after rounding).
+	size_t current_bytes;
+	/// Highest value 'current_bytes' reached. Kept on 'mem_zone_free_all'.
+	size_t peak_bytes;
+	/// Amount of allocations currently alive.
+	size_t alloc_count;
+	/// Bytes currently lost to rounding allocations up to 16 bytes, and to allocations moved to
+	/// another chunk by 'mem_zone_realloc_last'.
+	size_t wasted_bytes;
+	/// Amount of allocations that failed.
+	size_t failed_count;
+	/// Part of 'current_bytes' allocated from the top of the zone.
+	size_t top_bytes;
+	/// Part of 'alloc_count' allocated from the top of the zone.
+	size_t top_count;
+	/// Part of 'wasted_bytes' allocated from the top of the zone.
+	size_t top_wasted_bytes;
+	/// Total bytes requested for each tag. Kept on 'mem_zone_free_all'.
+	size_t tag_bytes[MEM_ZONE_STATS_MAX_TAGS];
+} MemZoneStats;
+#endif
+
+/*
+ * Define MEM_ZONE_GUARD (for the whole project) to help finding memory corruption. On this mode:
+ * - every allocation is followed by a 16 bytes guard, checked when the memory is freed
+ *   ('mem_zone_free_all' and 'mem_zone_rewind_to'). A damaged guard calls 'abort'.
+ * - freed memory is filled with MEM_ZONE_POISON, so stale pointers read garbage right away.
+ * - object pools poison freed objects and check them when they are reused (see 'object_pool.h').
+ */
+#ifdef MEM_ZONE_GUARD
+#ifndef MEM_ZONE_POISON
+/// Byte written to memory that was freed.
+#define MEM_ZONE_POISON 0xDE
+#endif
+#endif
+
+/// Amount of nested markers (on each side of the zone) that are checked to be rewound in order.
+#define MEM_ZONE_MARKER_CHECKS 8
+
+/**
+ * @brief Flags used by 'mem_zone_init_buffer'.
+ */
+typedef enum {
+	/// Clears the whole zone when initializing it (same as 'mem_zone_init').
+	MEM_ZONE_DEFAULT = 0,
+	/// Does not clear the zone when initializing it. Use 'mem_zone_alloc_zeroed' when needed.
+	MEM_ZONE_NO_CLEAR = 1 << 0,
+} MemZoneFlags;
+
+struct MemZone;
+
+/**
+ * @brief Called when an allocation cannot be done because the zone is out of memory. The
+ * allocation will return NULL after this call.
+ *
+ * @param memory_zone
+ *        MemZone that is out of memory.
+ * @param size
+ *        Size in bytes of the allocation that failed.
+ */
+typedef void (*fnMemZoneOverflowCallback)(struct MemZone *memory_zone, size_t size);
+
+/**
+ * @brief Overflow chunk of a chained MemZone. The usable memory comes right after this header.
+ */
+typedef struct MemZoneChunk {
+	/// Chunk allocated before this one. NULL if this is the first overflow chunk.
+	struct MemZoneChunk *prev;
+	/// Pointer to end of the chunk.
+	char *end;
+	/// Free space position of the previous block when this chunk was allocated.
+	char *prev_pos;
+} MemZoneChunk;
+
+/**
+ * @brief A contiguous zone where memory can be allocated.
+ *
+ * Memory is allocated from the start of the zone ('mem_zone_alloc') or from its end, growing down
+ * ('mem_zone_alloc_top'), so long-lived and short-lived data can share the same zone.
+ *
+ * If initialized with 'mem_zone_init_chained' the zone can grow by allocating overflow chunks.
+ * Only allocations from the start of the zone use the chunks.
+ */
+typedef struct MemZone {
 	/// Pointer to current free space position.
 	char *pos;
 	/// Pointer to start of zone.
 	char *start;
 	/// Pointer to end of zone.
 	char *end;
+	/// Pointer to the last allocation from the top of the zone. Same as 'end' if there's none.
+	char *top;
+	/// Pointer to end of the block currently used ('top' or the end of the current chunk).
+	char *limit;
+	/// Last allocation done by 'mem_zone_alloc'. NULL if it cannot be resized anymore.
+	char *last;
+	/// Size in bytes requested for 'last'.
+	size_t last_size;
+	/// Amount of markers currently open on the zone (see 'mem_zone_mark').
+	size_t marker_depth;
+	/// Amount of markers currently open on the top of the zone (see 'mem_zone_mark_top').
+	size_t top_marker_depth;
+	/// Serial number of the last marker created (on either side of the zone).
+	uint32_t marker_serial;
+	/// Serial number of the markers open on the zone, by depth. Used to find stale markers.
+	uint32_t marker_serials[MEM_ZONE_MARKER_CHECKS];
+	/// Serial number of the markers open on the top of the zone, by depth.
+	uint32_t top_marker_serials[MEM_ZONE_MARKER_CHECKS];
+	/// Overflow chunk currently used. NULL if allocating from the initial block.
+	MemZoneChunk *chunk;
+	/// Size of each overflow chunk. Zero if the zone cannot grow.
+	size_t chunk_size;
+	/// Maximum amount of bytes the zone can hold, including chunks. Zero if there's no limit.
+	size_t max_size;
+	/// Amount of bytes currently held by the zone, including chunks.
+	size_t total_size;
+	/// Function called when the zone is out of memory. Can be NULL.
+	fnMemZoneOverflowCallback overflow_callback;
+	/// If 'start' was allocated by the zone (and will be freed by 'mem_zone_destroy').
+	bool owns_memory;
+#ifdef MEM_ZONE_STATS
+	/// Usage of the zone.
+	MemZoneStats stats;
+#endif
 } MemZone;
 
+/**
+ * @brief Saved state of a MemZone. Created by 'mem_zone_mark' and used by 'mem_zone_rewind_to'.
+ */
+typedef struct {
+	/// Free space position ('pos' or 'top') when the marker was created.
+	char *pos;
+	/// Overflow chunk in use when the marker was created.
+	MemZoneChunk *chunk;
+	/// Nesting depth of the marker (1 for the outermost marker).
+	size_t depth;
+	/// Unique number of the marker on its zone, so a discarded marker is not mistaken for a new
+	/// one that reused its depth.
+	uint32_t serial;
+#ifdef MEM_ZONE_STATS
+	/// 'current_bytes' of the marked side of the zone when the marker was created.
+	size_t current_bytes;
+	/// 'alloc_count' of the marked side of the zone when the marker was created.
+	size_t alloc_count;
+	/// 'wasted_bytes' of the marked side of the zone when the marker was created.
+	size_t wasted_bytes;
+#endif
+} MemZoneMarker;
+
 /**
  * @brief Allocate a memory zone with the given size.
  *
@@ -27,6 +180,33 @@ typedef struct {
  */
 void mem_zone_init(MemZone *memory_zone, size_t size);
 
+/**
+ * @brief Initialize a memory zone using the buffer provided (eg.: a static array or a buffer placed
+ * on a linker section). No interrupts are disabled and, with MEM_ZONE_NO_CLEAR, the memory is not
+ * touched, so even big zones are initialized right away.
+ *
+ * @param memory_zone MemZone to use.
+ * @param buffer Memory used by the zone. Should be aligned to 16 bytes. If NULL will use 'malloc'.
+ * @param size Size in bytes of 'buffer'.
+ * @param flags Combination of MemZoneFlags.
+ */
+void mem_zone_init_buffer(MemZone *memory_zone, void *buffer, size_t size, MemZoneFlags flags);
+
+/**
+ * @brief Allocate a memory zone that grows when it runs out of space.
+ *
+ * When the current block is full, a new chunk of 'chunk_size' bytes (or the size requested, if
+ * bigger) is allocated using malloc. All chunks are released on 'mem_zone_free_all', going back to
+ * the initial block, so 'size' can be the common case instead of the peak.
+ *
+ * @param memory_zone MemZone to use.
+ * @param size Size in bytes of the initial block.
+ * @param chunk_size Size in bytes of each overflow chunk.
+ * @param max_size Maximum amount of bytes the zone can hold, including the initial block. Zero
+ * means no limit.
+ */
+void mem_zone_init_chained(MemZone *memory_zone, size_t size, size_t chunk_size, size_t max_size);
+
 /**
  * @brief Allocate memory from the zone.
  *
@@ -38,12 +218,153 @@ void mem_zone_init(MemZone *memory_zone, size_t size);
 void *mem_zone_alloc(MemZone *memory_zone, size_t size);
 
 /**
- * @brief Free all objects in the zone.
+ * @brief Resizes the last allocation done by 'mem_zone_alloc' in place. Useful to append to an
+ * array without knowing its final size (eg.: while parsing a file).
+ *
+ * If it doesn't fit in place and the zone is chained, the data is moved to a new chunk. The old
+ * block stays used (counted as wasted on the stats) until the zone is freed or rewound. Creating a
+ * marker or freeing the zone stops the last allocation from being resized.
+ *
+ * @param memory_zone MemZone to use.
+ * @param ptr Last allocation returned by 'mem_zone_alloc'. If NULL works like 'mem_zone_alloc'.
+ * @param size New size in bytes. If zero the allocation is freed.
+ *
+ * @return the memory resized (can be different from 'ptr' on chained zones), or NULL if it cannot
+ * be resized (in that case 'ptr' is still valid).
+ */
+void *mem_zone_realloc_last(MemZone *memory_zone, void *ptr, size_t size);
+
+/**
+ * @brief Allocate memory from the zone and set it to zero. Use it for zones initialized with
+ * MEM_ZONE_NO_CLEAR, or when reusing memory after 'mem_zone_free_all'.
+ *
+ * @param memory_zone MemZone to use.
+ * @param size Size in bytes of the memory. (eg.: sizeof(int))
+ *
+ * @return the memory allocated.
+ */
+void *mem_zone_alloc_zeroed(MemZone *memory_zone, size_t size);
+
+/**
+ * @brief Allocate memory from the end of the zone, growing down. Use it for short-lived data, so
+ * it can be freed by 'mem_zone_free_top' or 'mem_zone_rewind_top_to' without touching the data
+ * allocated by 'mem_zone_alloc'.
+ *
+ * @param memory_zone MemZone to use.
+ * @param size Size in bytes of the memory. (eg.: sizeof(int))
+ *
+ * @return the memory allocated, or NULL if it would overlap the start of the zone.
+ */
+void *mem_zone_alloc_top(MemZone *memory_zone, size_t size);
+
+#ifdef MEM_ZONE_STATS
+/**
+ * @brief Allocate memory from the zone, adding 'size' to the total of 'tag' on the zone stats.
+ * Allocations done by 'mem_zone_alloc' use tag 0.
+ *
+ * When MEM_ZONE_STATS is not defined this is the same as calling 'mem_zone_alloc'.
+ *
+ * @param memory_zone MemZone to use.
+ * @param size Size in bytes of the memory. (eg.: sizeof(int))
+ * @param tag Tag used to group the allocations. Tags from MEM_ZONE_STATS_MAX_TAGS on are only
+ * counted on the totals of the zone.
+ *
+ * @return the memory allocated.
+ */
+void *mem_zone_alloc_tagged(MemZone *memory_zone, size_t size, uint8_t tag);
+
+/**
+ * @brief Clears all stats of the zone, including the peak and tag totals.
+ *
+ * @param memory_zone MemZone to use.
+ */
+void mem_zone_stats_reset(MemZone *memory_zone);
+#else
+#define mem_zone_alloc_tagged(MEMORY_ZONE, SIZE, TAG) mem_zone_alloc(MEMORY_ZONE, SIZE)
+#endif
+
+/**
+ * @brief Sets the function called when an allocation fails because the zone is out of memory.
+ *
+ * @param memory_zone MemZone to use.
+ * @param callback Function to call. Can be NULL.
+ */
+void mem_zone_set_overflow_callback(MemZone *memory_zone, fnMemZoneOverflowCallback callback);
+
+/**
+ * @brief Free all objects in the zone (from both the start and the top). Also discards all open
+ * markers and releases all overflow chunks.
  *
  * @param memory_zone MemZone to use.
  */
 void mem_zone_free_all(MemZone *memory_zone);
 
+/**
+ * @brief Free all objects allocated with 'mem_zone_alloc', keeping the ones from the top of the
+ * zone. Also discards markers created by 'mem_zone_mark' and releases all overflow chunks.
+ *
+ * @param memory_zone MemZone to use.
+ */
+void mem_zone_free_bottom(MemZone *memory_zone);
+
+/**
+ * @brief Free all objects allocated with 'mem_zone_alloc_top'. Also discards markers created by
+ * 'mem_zone_mark_top'.
+ *
+ * @param memory_zone MemZone to use.
+ */
+void mem_zone_free_top(MemZone *memory_zone);
+
+/**
+ * @brief Releases all the memory used by the zone. The buffer sent to 'mem_zone_init_buffer' is not
+ * freed. The zone cannot be used after this call unless initialized again.
+ *
+ * @param memory_zone MemZone to destroy.
+ */
+void mem_zone_destroy(MemZone *memory_zone);
+
+/**
+ * @brief Opens a new marker on the zone. Everything allocated after this call can be freed at once
+ * by calling 'mem_zone_rewind_to' with the marker returned.
+ *
+ * Markers can be nested, but have to be rewound in the reverse order they were created. Rewinding
+ * a marker also discards all markers created after it.
+ *
+ * @param memory_zone MemZone to use.
+ *
+ * @return the marker with the current state of the zone.
+ */
+MemZoneMarker mem_zone_mark(MemZone *memory_zone);
+
+/**
+ * @brief Frees everything allocated after 'marker' was created, including overflow chunks.
+ *
+ * Asserts (when NDEBUG is not defined) if the marker was already discarded, either by rewinding an
+ * outer marker or by calling 'mem_zone_free_all', even if new markers were opened since then
+ * (checked for the first MEM_ZONE_MARKER_CHECKS nesting levels).
+ *
+ * @param memory_zone MemZone to use.
+ * @param marker Marker returned by 'mem_zone_mark' on the same zone.
+ */
+void mem_zone_rewind_to(MemZone *memory_zone, MemZoneMarker marker);
+
+/**
+ * @brief Same as 'mem_zone_mark', but for allocations done by 'mem_zone_alloc_top'.
+ *
+ * @param memory_zone MemZone to use.
+ *
+ * @return the marker with the current state of the top of the zone.
+ */
+MemZoneMarker mem_zone_mark_top(MemZone *memory_zone);
+
+/**
+ * @brief Frees everything allocated by 'mem_zone_alloc_top' after 'marker' was created.
+ *
+ * @param memory_zone MemZone to use.
+ * @param marker Marker returned by 'mem_zone_mark_top' on the same zone.
+ */
+void mem_zone_rewind_top_to(MemZone *memory_zone, MemZoneMarker marker);
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
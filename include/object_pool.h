@@ -7,11 +7,55 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 
 #include "mem_pool.h"
 
+#ifdef MEM_ZONE_GUARD
+// Poisons the object of a free item, except for the free list pointer at its start.
+static inline void objpool_poison_item(void *item, size_t item_size) {
+	if (item_size > sizeof(void *)) {
+		memset((char *)item + sizeof(void *), MEM_ZONE_POISON, item_size - sizeof(void *));
+	}
+}
+
+// Checks that the object of a free item was not written to since it was poisoned.
+static inline void objpool_check_item(void *item, size_t item_size) {
+	for (size_t i = sizeof(void *); i < item_size; ++i) {
+		if (((unsigned char *)item)[i] != MEM_ZONE_POISON) {
+			abort();  // Object was modified after being returned to the pool.
+		}
+	}
+}
+
+#define OBJPOOL_POISON_ITEM(ITEM) objpool_poison_item((ITEM), sizeof((ITEM)->data))
+#define OBJPOOL_CHECK_ITEM(ITEM) objpool_check_item((ITEM), sizeof((ITEM)->data))
+#else
+#define OBJPOOL_POISON_ITEM(ITEM)
+#define OBJPOOL_CHECK_ITEM(ITEM)
+#endif
+
+// Bitmap of the objects in use, so live objects can be visited without touching the free ones.
+#define OBJPOOL_LIVE_WORDS(NUM) (((NUM) + 31) >> 5)
+#define OBJPOOL_LIVE_GET(LIVE, INDEX) ((LIVE)[(INDEX) >> 5] & (1U << ((INDEX)&31)))
+#define OBJPOOL_LIVE_SET(LIVE, INDEX) ((LIVE)[(INDEX) >> 5] |= (1U << ((INDEX)&31)))
+#define OBJPOOL_LIVE_CLEAR(LIVE, INDEX) ((LIVE)[(INDEX) >> 5] &= ~(1U << ((INDEX)&31)))
+
+/**
+ * @brief Callback used by 'objpool_compact' after an object is moved.
+ *
+ * @param[in] old_obj
+ *            Where the object was. Still holds its data during the call, but is free after it.
+ * @param[in] new_obj
+ *            Where the object is now. Update all pointers to 'old_obj' to point here.
+ * @param[in] user
+ *            Pointer passed to 'objpool_compact'.
+ */
+typedef void (*fnObjPoolRelocateCallback)(void *old_obj, void *new_obj, void *user);
+
 /**
  * @brief Creates all structs and functions for the Object Pool for the type provided.
  *
@@ -19,60 +63,351 @@
  *            Type that will be used on the Object Pool.
  */
 #define OBJPOOL_INIT(TYPE)                                                                         \
-	typedef union objpool_##TYPE##_item_s objpool_##TYPE##_item_t;                                 \
-	union objpool_##TYPE##_item_s {                                                                \
-		objpool_##TYPE##_item_t *next;                                                             \
-		TYPE data;                                                                                 \
+	typedef struct objpool_##TYPE##_item_s objpool_##TYPE##_item_t;                                \
+	typedef struct objpool_##TYPE##_block_s objpool_##TYPE##_block_t;                              \
+	struct objpool_##TYPE##_item_s {                                                               \
+		union {                                                                                    \
+			objpool_##TYPE##_item_t *next;                                                         \
+			TYPE data;                                                                             \
+		};                                                                                         \
+		objpool_##TYPE##_block_t *block; /* block that owns the item, found in O(1) */             \
 	};                                                                                             \
-	typedef struct objpool_##TYPE##_s {                                                            \
+	struct objpool_##TYPE##_block_s {                                                              \
+		objpool_##TYPE##_block_t *next;                                                            \
 		objpool_##TYPE##_item_t *items;                                                            \
-		objpool_##TYPE##_item_t *head;                                                             \
+		uint32_t *live;                                                                            \
 		size_t num;                                                                                \
+		struct objpool_##TYPE##_s *pool;                                                           \
+	};                                                                                             \
+	typedef struct objpool_##TYPE##_s {                                                            \
+		objpool_##TYPE##_item_t *items; /* objects of the first block, same as 'block.items' */    \
+		size_t num;                     /* amount of objects of the first block */                 \
+		objpool_##TYPE##_block_t block; /* first block, always present */                          \
+		objpool_##TYPE##_block_t *first; /* block with the lowest address, blocks are sorted */    \
+		objpool_##TYPE##_item_t *head;                                                             \
+		MemZone *memory_pool;                                                                      \
+		size_t grow_num;                                                                           \
+		size_t block_count;                                                                        \
+		bool address_ordered;                                                                      \
 	} objpool_##TYPE##_t;                                                                          \
-	static inline objpool_##TYPE##_t *objpool_##TYPE##_create(MemZone *memory_pool,                \
-															  const size_t num) {                  \
+	static inline bool objpool_##TYPE##_block_alloc(objpool_##TYPE##_block_t *B,                   \
+													MemZone *memory_pool, const size_t num,        \
+													objpool_##TYPE##_item_t *tail) {               \
+		size_t live_size = OBJPOOL_LIVE_WORDS(num) * sizeof(uint32_t);                             \
+		if (memory_pool) {                                                                         \
+			B->items = mem_zone_alloc(memory_pool, num * sizeof(objpool_##TYPE##_item_t));         \
+			B->live = B->items ? mem_zone_alloc_zeroed(memory_pool, live_size) : NULL;             \
+		} else {                                                                                   \
+			B->items = calloc(num, sizeof(objpool_##TYPE##_item_t));                               \
+			B->live = B->items ? calloc(1, live_size) : NULL;                                      \
+			if (!B->live) {                                                                        \
+				free(B->items);                                                                    \
+			}                                                                                      \
+		}                                                                                          \
+		if (!B->live) {                                                                            \
+			return false;                                                                          \
+		}                                                                                          \
+		B->next = NULL;                                                                            \
+		B->num = num;                                                                              \
+		for (size_t i = 0; i < num - 1; i++) {                                                     \
+			B->items[i].next = &B->items[i + 1];                                                   \
+			B->items[i].block = B;                                                                 \
+			OBJPOOL_POISON_ITEM(&B->items[i]);                                                     \
+		}                                                                                          \
+		B->items[num - 1].next = tail;                                                             \
+		B->items[num - 1].block = B;                                                               \
+		OBJPOOL_POISON_ITEM(&B->items[num - 1]);                                                   \
+		return true;                                                                               \
+	}                                                                                              \
+	static inline objpool_##TYPE##_t *objpool_##TYPE##_create_growable(                            \
+		MemZone *memory_pool, const size_t num, const size_t grow_num) {                           \
 		if (num == 0) {                                                                            \
 			return NULL; /* creating pool with zero items */                                       \
 		}                                                                                          \
 		objpool_##TYPE##_t *P;                                                                     \
 		if (memory_pool) {                                                                         \
 			P = mem_zone_alloc(memory_pool, sizeof(objpool_##TYPE##_t));                           \
-			P->items = mem_zone_alloc(memory_pool, num * sizeof(objpool_##TYPE##_item_t));         \
 		} else {                                                                                   \
 			P = malloc(sizeof(objpool_##TYPE##_t));                                                \
-			P->items = calloc(num, sizeof(objpool_##TYPE##_item_t));                               \
 		}                                                                                          \
-		P->head = &P->items[0];                                                                    \
-		P->num = num;                                                                              \
-		for (size_t i = 0; i < num - 1; i++) {                                                     \
-			P->items[i].next = &P->items[i + 1];                                                   \
+		if (!objpool_##TYPE##_block_alloc(&P->block, memory_pool, num, NULL)) {                    \
+			abort(); /* Not enough memory for the pool. */                                         \
 		}                                                                                          \
-		P->items[num - 1].next = NULL;                                                             \
+		P->block.pool = P;                                                                         \
+		P->items = P->block.items;                                                                 \
+		P->num = P->block.num;                                                                     \
+		P->first = &P->block;                                                                      \
+		P->head = &P->block.items[0];                                                              \
+		P->memory_pool = memory_pool;                                                              \
+		P->grow_num = grow_num;                                                                    \
+		P->block_count = 1;                                                                        \
+		P->address_ordered = false;                                                                \
 		return P;                                                                                  \
+	}                                                                                              \
+	static inline objpool_##TYPE##_t *objpool_##TYPE##_create(MemZone *memory_pool,                \
+															  const size_t num) {                  \
+		return objpool_##TYPE##_create_growable(memory_pool, num, 0);                              \
 	}                                                                                              \
                                                                                                    \
 	static inline void objpool_##TYPE##_destroy(objpool_##TYPE##_t *P) {                           \
-		free(P->items);                                                                            \
+		objpool_##TYPE##_block_t *B = P->first;                                                    \
+		while (B) {                                                                                \
+			objpool_##TYPE##_block_t *next = B->next;                                              \
+			free(B->live);                                                                         \
+			free(B->items);                                                                        \
+			if (B != &P->block) {                                                                  \
+				free(B);                                                                           \
+			}                                                                                      \
+			B = next;                                                                              \
+		}                                                                                          \
 		free(P);                                                                                   \
 	}                                                                                              \
                                                                                                    \
+	/* Adds a block of 'grow_num' items in front of the free list. Returns NULL if it can't. */    \
+	static inline objpool_##TYPE##_block_t *objpool_##TYPE##_grow(objpool_##TYPE##_t *P) {         \
+		if (P->grow_num == 0) {                                                                    \
+			return NULL;                                                                           \
+		}                                                                                          \
+		objpool_##TYPE##_block_t *B;                                                               \
+		if (P->memory_pool) {                                                                      \
+			B = mem_zone_alloc(P->memory_pool, sizeof(objpool_##TYPE##_block_t));                  \
+		} else {                                                                                   \
+			B = malloc(sizeof(objpool_##TYPE##_block_t));                                          \
+		}                                                                                          \
+		if (!B) {                                                                                  \
+			return NULL;                                                                           \
+		}                                                                                          \
+		if (!objpool_##TYPE##_block_alloc(B, P->memory_pool, P->grow_num, P->head)) {              \
+			if (!P->memory_pool) {                                                                 \
+				free(B);                                                                           \
+			}                                                                                      \
+			return NULL;                                                                           \
+		}                                                                                          \
+		B->pool = P;                                                                               \
+		/* blocks are kept in address order, so walking them visits objects in address order */    \
+		objpool_##TYPE##_block_t **link = &P->first;                                               \
+		while (*link && (uintptr_t)(*link)->items < (uintptr_t)B->items) {                         \
+			link = &(*link)->next;                                                                 \
+		}                                                                                          \
+		B->next = *link;                                                                           \
+		*link = B;                                                                                 \
+		P->head = &B->items[0];                                                                    \
+		P->block_count++;                                                                          \
+		return B;                                                                                  \
+	}                                                                                              \
+                                                                                                   \
+	/* Returns the block that owns the item, or NULL if the item is not from the pool. */          \
+	/* Items outside of the first block are only read if the pool grew. */                         \
+	static inline objpool_##TYPE##_block_t *objpool_##TYPE##_block_of(                             \
+		objpool_##TYPE##_t *P, objpool_##TYPE##_item_t *I) {                                       \
+		if (I >= P->block.items && I < P->block.items + P->block.num) {                            \
+			return &P->block;                                                                      \
+		}                                                                                          \
+		if (P->block_count == 1) {                                                                 \
+			return NULL;                                                                           \
+		}                                                                                          \
+		objpool_##TYPE##_block_t *B = I->block;                                                    \
+		if (!B || B->pool != P || I < B->items || I >= B->items + B->num) {                        \
+			return NULL;                                                                           \
+		}                                                                                          \
+		return B;                                                                                  \
+	}                                                                                              \
+                                                                                                   \
+	/* Links all free items in address order, so the lowest ones are reused first. */              \
+	static inline void objpool_##TYPE##_rebuild_free_list(objpool_##TYPE##_t *P) {                 \
+		objpool_##TYPE##_item_t **tail = &P->head;                                                 \
+		for (objpool_##TYPE##_block_t *B = P->first; B; B = B->next) {                             \
+			for (size_t i = 0; i < B->num; ++i) {                                                  \
+				if (!OBJPOOL_LIVE_GET(B->live, i)) {                                               \
+					*tail = &B->items[i];                                                          \
+					tail = &B->items[i].next;                                                      \
+				}                                                                                  \
+			}                                                                                      \
+		}                                                                                          \
+		*tail = NULL;                                                                              \
+	}                                                                                              \
+                                                                                                   \
+	/* Address-ordered get: takes the lowest free item from the bitmap, not the free list. */      \
+	static inline TYPE *objpool_##TYPE##_get_lowest(objpool_##TYPE##_t *P) {                       \
+		for (objpool_##TYPE##_block_t *B = P->first;; B = B->next) {                               \
+			if (B == NULL) {                                                                       \
+				/* all blocks are full, so only the new one has free items */                      \
+				B = objpool_##TYPE##_grow(P);                                                      \
+				if (!B) {                                                                          \
+					return NULL;                                                                   \
+				}                                                                                  \
+				P->head = NULL; /* free list is not used in this mode */                           \
+			}                                                                                      \
+			for (size_t word = 0; word < OBJPOOL_LIVE_WORDS(B->num); ++word) {                     \
+				uint32_t bits = ~B->live[word];                                                    \
+				if (bits) {                                                                        \
+					size_t index = (word << 5) + __builtin_ctz(bits);                              \
+					if (index >= B->num) {                                                         \
+						break;                                                                     \
+					}                                                                              \
+					OBJPOOL_CHECK_ITEM(&B->items[index]);                                          \
+					OBJPOOL_LIVE_SET(B->live, index);                                              \
+					return &B->items[index].data;                                                  \
+				}                                                                                  \
+			}                                                                                      \
+		}                                                                                          \
+	}                                                                                              \
+                                                                                                   \
+	static inline void objpool_##TYPE##_set_address_ordered(objpool_##TYPE##_t *P, bool enabled) { \
+		P->address_ordered = enabled;                                                              \
+		if (enabled) {                                                                             \
+			P->head = NULL;                                                                        \
+		} else {                                                                                   \
+			objpool_##TYPE##_rebuild_free_list(P);                                                 \
+		}                                                                                          \
+	}                                                                                              \
+                                                                                                   \
 	static inline TYPE *objpool_##TYPE##_get(objpool_##TYPE##_t *P) {                              \
+		if (P->address_ordered) {                                                                  \
+			return objpool_##TYPE##_get_lowest(P);                                                 \
+		}                                                                                          \
 		objpool_##TYPE##_item_t *item = P->head;                                                   \
 		if (item == NULL) {                                                                        \
-			return NULL;                                                                           \
+			if (!objpool_##TYPE##_grow(P)) {                                                       \
+				return NULL;                                                                       \
+			}                                                                                      \
+			item = P->head;                                                                        \
 		}                                                                                          \
+		OBJPOOL_CHECK_ITEM(item);                                                                  \
 		P->head = item->next;                                                                      \
+		OBJPOOL_LIVE_SET(item->block->live, item - item->block->items);                            \
 		return &item->data;                                                                        \
 	}                                                                                              \
                                                                                                    \
+	static inline size_t objpool_##TYPE##_get_n(objpool_##TYPE##_t *P, TYPE **out, size_t n) {     \
+		if (P->address_ordered) {                                                                  \
+			size_t count = 0;                                                                      \
+			while (count < n && (out[count] = objpool_##TYPE##_get_lowest(P))) {                   \
+				count++;                                                                           \
+			}                                                                                      \
+			return count;                                                                          \
+		}                                                                                          \
+		objpool_##TYPE##_item_t *item = P->head;                                                   \
+		size_t count = 0;                                                                          \
+		while (count < n) {                                                                        \
+			if (item == NULL) {                                                                    \
+				P->head = NULL;                                                                    \
+				if (!objpool_##TYPE##_grow(P)) {                                                   \
+					break;                                                                         \
+				}                                                                                  \
+				item = P->head;                                                                    \
+			}                                                                                      \
+			OBJPOOL_CHECK_ITEM(item);                                                              \
+			OBJPOOL_LIVE_SET(item->block->live, item - item->block->items);                        \
+			out[count++] = &item->data;                                                            \
+			item = item->next;                                                                     \
+		}                                                                                          \
+		P->head = item;                                                                            \
+		return count;                                                                              \
+	}                                                                                              \
+                                                                                                   \
+	static inline TYPE *objpool_##TYPE##_next(objpool_##TYPE##_t *P, TYPE *PREV) {                 \
+		objpool_##TYPE##_block_t *B = P->first;                                                    \
+		size_t index = 0;                                                                          \
+		if (PREV) {                                                                                \
+			B = objpool_##TYPE##_block_of(P, (objpool_##TYPE##_item_t *)PREV);                     \
+			if (!B) {                                                                              \
+				return NULL;                                                                       \
+			}                                                                                      \
+			index = (size_t)((objpool_##TYPE##_item_t *)PREV - B->items) + 1;                      \
+		}                                                                                          \
+		for (; B; B = B->next, index = 0) {                                                        \
+			if (index >= B->num) {                                                                 \
+				continue;                                                                          \
+			}                                                                                      \
+			size_t word = index >> 5;                                                              \
+			uint32_t bits = B->live[word] & (~0U << (index & 31));                                 \
+			while (!bits && ++word < OBJPOOL_LIVE_WORDS(B->num)) {                                 \
+				bits = B->live[word];                                                              \
+			}                                                                                      \
+			if (bits) {                                                                            \
+				return &B->items[(word << 5) + __builtin_ctz(bits)].data;                          \
+			}                                                                                      \
+		}                                                                                          \
+		return NULL;                                                                               \
+	}                                                                                              \
+                                                                                                   \
 	static inline bool objpool_##TYPE##_free(objpool_##TYPE##_t *P, TYPE *OBJ) {                   \
 		objpool_##TYPE##_item_t *I = (objpool_##TYPE##_item_t *)OBJ;                               \
-		if ((I < P->items) || (I >= (P->items + P->num))) {                                        \
+		objpool_##TYPE##_block_t *B = objpool_##TYPE##_block_of(P, I);                             \
+		if (!B || !OBJPOOL_LIVE_GET(B->live, I - B->items)) {                                      \
 			return false;                                                                          \
 		}                                                                                          \
-		I->next = P->head;                                                                         \
-		P->head = I;                                                                               \
+		OBJPOOL_LIVE_CLEAR(B->live, I - B->items);                                                 \
+		if (!P->address_ordered) {                                                                 \
+			I->next = P->head;                                                                     \
+			P->head = I;                                                                           \
+		}                                                                                          \
+		OBJPOOL_POISON_ITEM(I);                                                                    \
 		return true;                                                                               \
+	}                                                                                              \
+                                                                                                   \
+	static inline size_t objpool_##TYPE##_free_n(objpool_##TYPE##_t *P, TYPE **objs, size_t n) {   \
+		objpool_##TYPE##_item_t *head = P->head;                                                   \
+		size_t count = 0;                                                                          \
+		for (size_t i = 0; i < n; ++i) {                                                           \
+			objpool_##TYPE##_item_t *I = (objpool_##TYPE##_item_t *)objs[i];                       \
+			objpool_##TYPE##_block_t *B = objpool_##TYPE##_block_of(P, I);                         \
+			if (!B || !OBJPOOL_LIVE_GET(B->live, I - B->items)) {                                  \
+				continue;                                                                          \
+			}                                                                                      \
+			OBJPOOL_LIVE_CLEAR(B->live, I - B->items);                                             \
+			if (!P->address_ordered) {                                                             \
+				I->next = head;                                                                    \
+				head = I;                                                                          \
+			}                                                                                      \
+			OBJPOOL_POISON_ITEM(I);                                                                \
+			count++;                                                                               \
+		}                                                                                          \
+		P->head = head;                                                                            \
+		return count;                                                                              \
+	}                                                                                              \
+                                                                                                   \
+	static inline size_t objpool_##TYPE##_compact(                                                 \
+		objpool_##TYPE##_t *P, fnObjPoolRelocateCallback relocate, void *user) {                   \
+		objpool_##TYPE##_block_t *FB = P->first; /* cursor to the lowest free item */              \
+		size_t fi = 0;                                                                             \
+		size_t moved = 0;                                                                          \
+		for (objpool_##TYPE##_block_t *B = P->first; B; B = B->next) {                             \
+			for (size_t i = 0; i < B->num; ++i) {                                                  \
+				if (!OBJPOOL_LIVE_GET(B->live, i)) {                                               \
+					continue;                                                                      \
+				}                                                                                  \
+				while (FB != B || fi < i) {                                                        \
+					if (fi >= FB->num) {                                                           \
+						FB = FB->next;                                                             \
+						fi = 0;                                                                    \
+					} else if (!OBJPOOL_LIVE_GET(FB->live, fi)) {                                  \
+						break;                                                                     \
+					} else {                                                                       \
+						fi++;                                                                      \
+					}                                                                              \
+				}                                                                                  \
+				if (FB == B && fi >= i) {                                                          \
+					continue; /* no free item before this object */                                \
+				}                                                                                  \
+				FB->items[fi].data = B->items[i].data;                                             \
+				OBJPOOL_LIVE_SET(FB->live, fi);                                                    \
+				OBJPOOL_LIVE_CLEAR(B->live, i);                                                    \
+				if (relocate) {                                                                    \
+					relocate(&B->items[i].data, &FB->items[fi].data, user);                        \
+				}                                                                                  \
+				OBJPOOL_POISON_ITEM(&B->items[i]);                                                 \
+				fi++;                                                                              \
+				moved++;                                                                           \
+			}                                                                                      \
+		}                                                                                          \
+		if (P->address_ordered) {                                                                  \
+			P->head = NULL;                                                                        \
+		} else {                                                                                   \
+			objpool_##TYPE##_rebuild_free_list(P);                                                 \
+		}                                                                                          \
+		return moved;                                                                              \
 	}
 
 #define objpool_t(TYPE) objpool_##TYPE##_t
@@ -90,6 +425,34 @@
  */
 #define objpool_create(TYPE, MEMORY_POOL, NUM) objpool_##TYPE##_create(MEMORY_POOL, NUM)
 
+/**
+ * @brief Allocates an object pool that grows when all objects are in use, instead of returning
+ * NULL.
+ *
+ * New objects are added in blocks of GROW_NUM, allocated from the same memory pool (or malloc). Use
+ * 'objpool_block_count' to check how many blocks were needed and size NUM accordingly.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] MEMORY_POOL
+ *            MemZone that will be used to allocate the object pool. If NULL will used malloc/calloc
+ * instead (remember to call 'objpool_destroy' in that case).
+ * @param[in] NUM
+ *            Amount of objects in the first block.
+ * @param[in] GROW_NUM
+ *            Amount of objects added every time the pool runs out. 0 to never grow.
+ */
+#define objpool_create_growable(TYPE, MEMORY_POOL, NUM, GROW_NUM)                                  \
+	objpool_##TYPE##_create_growable(MEMORY_POOL, NUM, GROW_NUM)
+
+/**
+ * @brief Amount of blocks allocated by the pool, including the first one.
+ *
+ * @param[in] POOL
+ *            Object pool to check.
+ */
+#define objpool_block_count(POOL) ((POOL)->block_count)
+
 /**
  * @brief Destroy the Object Pool provided. Only use this if not using a memory pool.
  *
@@ -102,7 +465,7 @@
 
 /**
  * @brief Get a new object from the pool. Returns NULL if there are no objects available (all are in
- * use).
+ * use) and the pool cannot grow.
  *
  * @param[in] TYPE
  *            Type used when creating the object pool.
@@ -119,6 +482,106 @@
  * @param[in] POOL
  *            Object pool to get the object from.
  * @param[in] OBJ
- *            Object that will be returned to the pool. Do not use this object after this call.
+ *            Object that will be returned to the pool. Do not use this object after this call. On
+ * pools that grew, it has to be an object from a pool of the same TYPE.
+ *
+ * @return false if the object is not from the pool or was already freed.
  */
 #define objpool_free(TYPE, POOL, OBJ) objpool_##TYPE##_free(POOL, OBJ)
+
+/**
+ * @brief Get up to N objects from the pool at once, growing it if needed. Faster than calling
+ * 'objpool_get' N times when spawning bursts of objects.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to get the objects from.
+ * @param[out] OUT
+ *            Array ('TYPE *OUT[N]') that will receive the objects.
+ * @param[in] N
+ *            Amount of objects to get.
+ *
+ * @return Amount of objects written to OUT. Less than N if the pool ran out.
+ */
+#define objpool_get_n(TYPE, POOL, OUT, N) objpool_##TYPE##_get_n(POOL, OUT, N)
+
+/**
+ * @brief Returns N objects to the object pool at once.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to return the objects to.
+ * @param[in] OBJS
+ *            Array ('TYPE *OBJS[N]') with the objects to return. Do not use them after this call.
+ * On pools that grew, they have to be objects from pools of the same TYPE.
+ * @param[in] N
+ *            Amount of objects in OBJS.
+ *
+ * @return Amount of objects returned. Objects not from the pool or already freed are skipped.
+ */
+#define objpool_free_n(TYPE, POOL, OBJS, N) objpool_##TYPE##_free_n(POOL, OBJS, N)
+
+/**
+ * @brief Changes how free objects are reused. By default the last freed object is reused first,
+ * which is O(1) but scatters objects over time. When address-ordered, 'objpool_get' returns the
+ * free object with the lowest address instead, keeping objects packed at the start of the pool at
+ * the cost of scanning the bitmap (32 objects per step).
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to change.
+ * @param[in] ENABLED
+ *            true to reuse the lowest free object first, false for the default behavior.
+ */
+#define objpool_set_address_ordered(TYPE, POOL, ENABLED)                                           \
+	objpool_##TYPE##_set_address_ordered(POOL, ENABLED)
+
+/**
+ * @brief Moves objects in use to the lowest free positions of the pool, so they are packed at the
+ * start. Objects keep their relative order. After this, free objects are reused in address order.
+ *
+ * Any pointer to a moved object must be updated on the RELOCATE callback.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to compact.
+ * @param[in] RELOCATE
+ *            Callback called for every object moved (see 'fnObjPoolRelocateCallback'). Can be NULL.
+ * @param[in] USER
+ *            Pointer passed to the callback.
+ *
+ * @return Amount of objects moved.
+ */
+#define objpool_compact(TYPE, POOL, RELOCATE, USER) objpool_##TYPE##_compact(POOL, RELOCATE, USER)
+
+/**
+ * @brief Get the next object in use, in address order. Returns NULL if there are no more objects.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to get the object from.
+ * @param[in] PREV
+ *            Object returned by the previous call. NULL to get the first object.
+ */
+#define objpool_next(TYPE, POOL, PREV) objpool_##TYPE##_next(POOL, PREV)
+
+/**
+ * @brief Loops through all objects in use, in address order. Skips 32 free objects at a time, so
+ * the cost depends on the objects in use instead of the pool size.
+ *
+ * Freeing the current object inside the loop is allowed.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the object pool.
+ * @param[in] POOL
+ *            Object pool to loop through.
+ * @param[in] VAR
+ *            Name of the variable ('TYPE *') that will hold each object.
+ */
+#define objpool_foreach(TYPE, POOL, VAR)                                                           \
+	for (TYPE *VAR = objpool_next(TYPE, POOL, NULL); VAR; VAR = objpool_next(TYPE, POOL, VAR))
@@ -2,6 +2,7 @@
 
 #include <libdragon.h>
 #include "mem_pool.h"
+#include "frame_allocator.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,6 +55,8 @@ typedef struct {
 	short next_scene_id;
 	/// Scene memory pool. If !NULL will call 'mem_zone_free_all' when changing scenes.
 	MemZone *scene_memory_pool;
+	/// Per-frame allocator. If !NULL will be flipped every tick and reset when changing scenes.
+	FrameAllocator *frame_allocator;
 	/// Function that will be called when changing the scene. Called by 'scene_manager_tick'.
 	fnSMSceneChangeCallback change_scene_callback;
 	/// Callbacks used by the scene.
@@ -105,6 +108,18 @@ void scene_manager_set_callbacks(SceneManager *scene_manager, fnSMCreateCallback
 								 fnSMDisplayCallback display_callback,
 								 fnSMDestroyCallback destroy_callback);
 
+/**
+ * @brief Sets the FrameAllocator that will be flipped at the start of every 'scene_manager_tick'.
+ * Both frames are also freed when changing scenes.
+ *
+ * @param[in] scene_manager
+ *            The Scene Manager.
+ * @param[in] frame_allocator
+ *            FrameAllocator to use. Can be NULL to stop flipping it.
+ */
+void scene_manager_set_frame_allocator(SceneManager *scene_manager,
+									   FrameAllocator *frame_allocator);
+
 /**
  * @brief Ticks the scene manager. Will change the scene if needed.
  *
@@ -0,0 +1,194 @@
+/**
+ * @file slot_pool.h
+ * @brief Macro-based Object Pooling that hands out generational handles instead of pointers.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "mem_pool.h"
+
+/**
+ * @brief Handle to an object of a slot pool. The lower 16 bits are the index of the object, and the
+ * upper 16 bits are its generation (incremented every time the object is handed out and freed, so
+ * it is odd while the object is in use and handles to free objects never resolve).
+ */
+typedef uint32_t slotpool_handle_t;
+
+/// Handle that never resolves to an object.
+#define SLOTPOOL_INVALID_HANDLE 0
+/// Maximum amount of objects in a slot pool.
+#define SLOTPOOL_MAX_ITEMS 0xFFFF
+
+#define SLOTPOOL_HANDLE(INDEX, GENERATION) (((slotpool_handle_t)(GENERATION) << 16) | (INDEX))
+#define SLOTPOOL_HANDLE_INDEX(HANDLE) ((HANDLE)&0xFFFF)
+#define SLOTPOOL_HANDLE_GENERATION(HANDLE) ((HANDLE) >> 16)
+#define SLOTPOOL_GENERATION_IS_LIVE(GENERATION) ((GENERATION)&1)
+
+/**
+ * @brief Creates all structs and functions for the Slot Pool for the type provided.
+ *
+ * @param[in] TYPE
+ *            Type that will be used on the Slot Pool.
+ */
+#define SLOTPOOL_INIT(TYPE)                                                                        \
+	typedef union slotpool_##TYPE##_item_s {                                                       \
+		uint16_t next;                                                                             \
+		TYPE data;                                                                                 \
+	} slotpool_##TYPE##_item_t;                                                                    \
+	typedef struct slotpool_##TYPE##_s {                                                           \
+		slotpool_##TYPE##_item_t *items;                                                           \
+		uint16_t *generations;                                                                     \
+		uint16_t head;                                                                             \
+		size_t num;                                                                                \
+	} slotpool_##TYPE##_t;                                                                         \
+	static inline slotpool_##TYPE##_t *slotpool_##TYPE##_create(MemZone *memory_pool,              \
+																const size_t num) {                \
+		if (num == 0 || num >= SLOTPOOL_MAX_ITEMS) {                                               \
+			return NULL; /* creating pool with zero items or too many */                           \
+		}                                                                                          \
+		slotpool_##TYPE##_t *P;                                                                    \
+		if (memory_pool) {                                                                         \
+			P = mem_zone_alloc(memory_pool, sizeof(slotpool_##TYPE##_t));                          \
+			P->items = mem_zone_alloc(memory_pool, num * sizeof(slotpool_##TYPE##_item_t));        \
+			P->generations = mem_zone_alloc(memory_pool, num * sizeof(uint16_t));                  \
+		} else {                                                                                   \
+			P = malloc(sizeof(slotpool_##TYPE##_t));                                               \
+			P->items = calloc(num, sizeof(slotpool_##TYPE##_item_t));                              \
+			P->generations = calloc(num, sizeof(uint16_t));                                        \
+		}                                                                                          \
+		P->head = 0;                                                                               \
+		P->num = num;                                                                              \
+		for (size_t i = 0; i < num; i++) {                                                         \
+			P->items[i].next = i + 1 < num ? i + 1 : SLOTPOOL_MAX_ITEMS;                           \
+			P->generations[i] = 0;                                                                 \
+		}                                                                                          \
+		return P;                                                                                  \
+	}                                                                                              \
+                                                                                                   \
+	static inline void slotpool_##TYPE##_destroy(slotpool_##TYPE##_t *P) {                         \
+		free(P->generations);                                                                      \
+		free(P->items);                                                                            \
+		free(P);                                                                                   \
+	}                                                                                              \
+                                                                                                   \
+	static inline slotpool_handle_t slotpool_##TYPE##_get(slotpool_##TYPE##_t *P) {                \
+		uint16_t index = P->head;                                                                  \
+		if (index == SLOTPOOL_MAX_ITEMS) {                                                         \
+			return SLOTPOOL_INVALID_HANDLE;                                                        \
+		}                                                                                          \
+		P->head = P->items[index].next;                                                            \
+		/* odd generation, so a handle is never 0 */                                               \
+		return SLOTPOOL_HANDLE(index, ++P->generations[index]);                                    \
+	}                                                                                              \
+                                                                                                   \
+	static inline TYPE *slotpool_##TYPE##_resolve(slotpool_##TYPE##_t *P, slotpool_handle_t H) {   \
+		uint32_t index = SLOTPOOL_HANDLE_INDEX(H);                                                 \
+		if (index >= P->num || P->generations[index] != SLOTPOOL_HANDLE_GENERATION(H) ||           \
+			!SLOTPOOL_GENERATION_IS_LIVE(P->generations[index])) {                                 \
+			return NULL;                                                                           \
+		}                                                                                          \
+		return &P->items[index].data;                                                              \
+	}                                                                                              \
+                                                                                                   \
+	static inline slotpool_handle_t slotpool_##TYPE##_handle_of(slotpool_##TYPE##_t *P,            \
+																TYPE *OBJ) {                       \
+		slotpool_##TYPE##_item_t *I = (slotpool_##TYPE##_item_t *)OBJ;                             \
+		if ((I < P->items) || (I >= (P->items + P->num))) {                                        \
+			return SLOTPOOL_INVALID_HANDLE;                                                        \
+		}                                                                                          \
+		size_t index = I - P->items;                                                               \
+		if (!SLOTPOOL_GENERATION_IS_LIVE(P->generations[index])) {                                 \
+			return SLOTPOOL_INVALID_HANDLE;                                                        \
+		}                                                                                          \
+		return SLOTPOOL_HANDLE(index, P->generations[index]);                                      \
+	}                                                                                              \
+                                                                                                   \
+	static inline bool slotpool_##TYPE##_free(slotpool_##TYPE##_t *P, slotpool_handle_t H) {       \
+		if (!slotpool_##TYPE##_resolve(P, H)) {                                                    \
+			return false;                                                                          \
+		}                                                                                          \
+		uint16_t index = SLOTPOOL_HANDLE_INDEX(H);                                                 \
+		++P->generations[index];                                                                   \
+		P->items[index].next = P->head;                                                            \
+		P->head = index;                                                                           \
+		return true;                                                                               \
+	}
+
+#define slotpool_t(TYPE) slotpool_##TYPE##_t
+
+/**
+ * @brief Allocates a slot pool for the type provided.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] MEMORY_POOL
+ *            MemZone that will be used to allocate the slot pool. If NULL will used malloc/calloc
+ * instead (remember to call 'slotpool_destroy' in that case).
+ * @param[in] NUM
+ *            Amount of objects in the slot pool (up to SLOTPOOL_MAX_ITEMS - 1).
+ */
+#define slotpool_create(TYPE, MEMORY_POOL, NUM) slotpool_##TYPE##_create(MEMORY_POOL, NUM)
+
+/**
+ * @brief Destroy the Slot Pool provided. Only use this if not using a memory pool.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] POOL
+ *            Slot pool to destroy.
+ */
+#define slotpool_destroy(TYPE, POOL) slotpool_##TYPE##_destroy(POOL)
+
+/**
+ * @brief Get a new object from the pool. Returns SLOTPOOL_INVALID_HANDLE if there are no objects
+ * available (all are in use).
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] POOL
+ *            Slot pool to get the object from.
+ */
+#define slotpool_get(TYPE, POOL) slotpool_##TYPE##_get(POOL)
+
+/**
+ * @brief Get the object of a handle. Returns NULL if the handle is invalid or its object was freed.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] POOL
+ *            Slot pool that created the handle.
+ * @param[in] HANDLE
+ *            Handle returned by 'slotpool_get'.
+ */
+#define slotpool_resolve(TYPE, POOL, HANDLE) slotpool_##TYPE##_resolve(POOL, HANDLE)
+
+/**
+ * @brief Get the handle of an object of the pool. Returns SLOTPOOL_INVALID_HANDLE if the object is
+ * not from the pool or is not in use.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] POOL
+ *            Slot pool that has the object.
+ * @param[in] OBJ
+ *            Object returned by 'slotpool_resolve'.
+ */
+#define slotpool_handle_of(TYPE, POOL, OBJ) slotpool_##TYPE##_handle_of(POOL, OBJ)
+
+/**
+ * @brief Returns an object to the slot pool so that it can be reused later. All handles to it stop
+ * resolving. Returns false if the handle is invalid or was already freed.
+ *
+ * @param[in] TYPE
+ *            Type used when creating the slot pool.
+ * @param[in] POOL
+ *            Slot pool that created the handle.
+ * @param[in] HANDLE
+ *            Handle of the object that will be returned to the pool.
+ */
+#define slotpool_free(TYPE, POOL, HANDLE) slotpool_##TYPE##_free(POOL, HANDLE)
\ No newline at end of file
@@ -0,0 +1,139 @@
+/**
+ * @file soa_pool.h
+ * @brief Macro-based pool that stores each field of the objects in its own array
+ * (Structure-of-Arrays), so loops that only touch a few fields do not load the others into cache.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include "mem_pool.h"
+
+/// Index returned by 'soapool_add' when the pool is full.
+#define SOAPOOL_INVALID_INDEX ((size_t)-1)
+
+#define SOAPOOL_FIELD_DECLARE(FIELD_TYPE, FIELD_NAME) FIELD_TYPE *FIELD_NAME;
+#define SOAPOOL_FIELD_ALLOC(FIELD_TYPE, FIELD_NAME)                                                \
+	P->FIELD_NAME = memory_pool ? mem_zone_alloc(memory_pool, num * sizeof(FIELD_TYPE))            \
+								: calloc(num, sizeof(FIELD_TYPE));
+#define SOAPOOL_FIELD_FREE(FIELD_TYPE, FIELD_NAME) free(P->FIELD_NAME);
+#define SOAPOOL_FIELD_MOVE(FIELD_TYPE, FIELD_NAME) P->FIELD_NAME[index] = P->FIELD_NAME[P->count];
+
+/**
+ * @brief Creates all structs and functions for the SoA Pool with the fields provided.
+ *
+ * @param[in] NAME
+ *            Name of the pool type (used the same way as TYPE on the Object Pool).
+ * @param[in] FIELDS
+ *            Macro that lists the fields, calling its argument with (type, name) for each one. Eg.:
+ *            '#define PARTICLE_FIELDS(FIELD) FIELD(float, x) FIELD(float, y) FIELD(int, life)'
+ */
+#define SOAPOOL_INIT(NAME, FIELDS)                                                                 \
+	typedef struct soapool_##NAME##_s {                                                            \
+		FIELDS(SOAPOOL_FIELD_DECLARE)                                                              \
+		size_t count;                                                                              \
+		size_t num;                                                                                \
+	} soapool_##NAME##_t;                                                                          \
+	static inline soapool_##NAME##_t *soapool_##NAME##_create(MemZone *memory_pool,                \
+															  const size_t num) {                  \
+		if (num == 0) {                                                                            \
+			return NULL; /* creating pool with zero items */                                       \
+		}                                                                                          \
+		soapool_##NAME##_t *P;                                                                     \
+		if (memory_pool) {                                                                         \
+			P = mem_zone_alloc(memory_pool, sizeof(soapool_##NAME##_t));                           \
+		} else {                                                                                   \
+			P = malloc(sizeof(soapool_##NAME##_t));                                                \
+		}                                                                                          \
+		FIELDS(SOAPOOL_FIELD_ALLOC)                                                                \
+		P->count = 0;                                                                              \
+		P->num = num;                                                                              \
+		return P;                                                                                  \
+	}                                                                                              \
+                                                                                                   \
+	static inline void soapool_##NAME##_destroy(soapool_##NAME##_t *P) {                           \
+		FIELDS(SOAPOOL_FIELD_FREE)                                                                 \
+		free(P);                                                                                   \
+	}                                                                                              \
+                                                                                                   \
+	static inline size_t soapool_##NAME##_add(soapool_##NAME##_t *P) {                             \
+		if (P->count == P->num) {                                                                  \
+			return SOAPOOL_INVALID_INDEX;                                                          \
+		}                                                                                          \
+		return P->count++;                                                                         \
+	}                                                                                              \
+                                                                                                   \
+	static inline bool soapool_##NAME##_remove(soapool_##NAME##_t *P, size_t index) {              \
+		if (index >= P->count) {                                                                   \
+			return false;                                                                          \
+		}                                                                                          \
+		P->count--;                                                                                \
+		if (index != P->count) {                                                                   \
+			FIELDS(SOAPOOL_FIELD_MOVE)                                                             \
+		}                                                                                          \
+		return true;                                                                               \
+	}
+
+#define soapool_t(NAME) soapool_##NAME##_t
+
+/**
+ * @brief Allocates a SoA pool with the fields provided on 'SOAPOOL_INIT'.
+ *
+ * @param[in] NAME
+ *            Name used when creating the pool.
+ * @param[in] MEMORY_POOL
+ *            MemZone that will be used to allocate the pool. If NULL will used malloc/calloc
+ * instead (remember to call 'soapool_destroy' in that case).
+ * @param[in] NUM
+ *            Amount of objects in the pool.
+ */
+#define soapool_create(NAME, MEMORY_POOL, NUM) soapool_##NAME##_create(MEMORY_POOL, NUM)
+
+/**
+ * @brief Destroy the SoA pool provided. Only use this if not using a memory pool.
+ *
+ * @param[in] NAME
+ *            Name used when creating the pool.
+ * @param[in] POOL
+ *            Pool to destroy.
+ */
+#define soapool_destroy(NAME, POOL) soapool_##NAME##_destroy(POOL)
+
+/**
+ * @brief Adds a new object at the end of the pool and returns its index. Fields are not cleared.
+ * Returns SOAPOOL_INVALID_INDEX if the pool is full.
+ *
+ * @param[in] NAME
+ *            Name used when creating the pool.
+ * @param[in] POOL
+ *            Pool to add the object to.
+ */
+#define soapool_add(NAME, POOL) soapool_##NAME##_add(POOL)
+
+/**
+ * @brief Removes the object at INDEX by moving the last object into its place, so the arrays stay
+ * dense. Indexes of other objects do not change, except for the last one.
+ *
+ * When removing inside a loop, loop from the end or do not advance the index after removing.
+ *
+ * @param[in] NAME
+ *            Name used when creating the pool.
+ * @param[in] POOL
+ *            Pool to remove the object from.
+ * @param[in] INDEX
+ *            Index of the object to remove.
+ *
+ * @return false if INDEX is not in use.
+ */
+#define soapool_remove(NAME, POOL, INDEX) soapool_##NAME##_remove(POOL, INDEX)
+
+/**
+ * @brief Amount of objects in use. They are always at indexes 0 to count - 1.
+ *
+ * @param[in] POOL
+ *            Pool to check.
+ */
+#define soapool_count(POOL) ((POOL)->count)
@@ -2,6 +2,7 @@
 
 #include <libdragon.h>
 #include "mem_pool.h"
+#include "mem_heap.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -33,6 +34,29 @@ inline sprite_t *spritesheet_load(MemZone *memory_pool, const char *sprite_path)
 	return sprite;
 }
 
+/**
+ * @brief Loads and allocate a sprite_t on the MemHeap. Use it for sprites that are loaded and
+ * unloaded during a scene.
+ *
+ * @param heap
+ *        MemHeap to allocate the sprite_t. Call 'mem_heap_free' when the sprite is not needed
+ * anymore.
+ * @param sprite_path
+ *        Path to the sprite (eg.: "/sprites/my_sprite.sprite").
+ *
+ * @return The new sprite, or NULL if there's no space left on the heap.
+ */
+inline sprite_t *spritesheet_load_heap(MemHeap *heap, const char *sprite_path) {
+	int fp = dfs_open(sprite_path);
+
+	sprite_t *sprite = (sprite_t *)mem_heap_alloc(heap, dfs_size(fp));
+	if (sprite)
+		dfs_read(sprite, 1, dfs_size(fp), fp);
+	dfs_close(fp);
+
+	return sprite;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <libdragon.h>
 #include "mem_pool.h"
 #include "rect.h"
+#include "tiled_tile.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,14 +13,16 @@ extern "C" {
  * @brief Struct that holds a Tiled map.
  */
 typedef struct {
-	/// Map data.
-	char *map;
+	/// Map data. Empty tiles are TILED_EMPTY_TILE.
+	tiled_index_t *map;
 	/// Size of the map in tiles.
 	Size map_size;
 	/// Size of each tile.
 	Size tile_size;
 	/// Sprite used to render.
 	sprite_t *sprite;
+	/// Spans of non-empty tiles of each row, so rendering skips empty tiles.
+	TiledRowRuns row_runs;
 } Tiled;
 
 // Init a Tiled map
@@ -34,7 +37,8 @@ typedef struct {
  * @param map_path
  *        Path to the map file (eg.: "/maps/my_map.csv"). Has to be a CSV file.
  * @param map_size
- *        Size of the map in tiles.
+ *        Size of the map in tiles. If zero, the size is read from the file (width is the amount of
+ * tiles on the first row).
  * @param tile_size
  *        Size of each tile.
  *
@@ -43,6 +47,35 @@ typedef struct {
 Tiled *tiled_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path, Size map_size,
 				  Size tile_size);
 
+/**
+ * @brief Allocates, loads, and initializes the Tiled map from a binary map (see 'tiled_bin.h').
+ * Map and tile sizes are read from the file, and the tiles are read directly into the map with no
+ * parsing. Only the first layer is loaded.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc', in that case remember to call
+ * 'tiled_destroy' to free the memory allocated.
+ * @param sprite
+ *        Sprite used to render.
+ * @param map_path
+ *        Path to the binary map file (eg.: "/maps/my_map.bin"), created with 'tiled_convert'.
+ *
+ * @return The new Tiled.
+ */
+Tiled *tiled_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path);
+
+/**
+ * @brief Finds the non-empty tiles of each row again. Already called on init, only call this after
+ * changing empty tiles of the map to non-empty ones (otherwise they are not rendered).
+ *
+ * @param memory_pool
+ *        Same MemZone used on init (or NULL if not using one). When using a memory pool, the new
+ * spans are allocated from it again, so avoid calling this often.
+ * @param tiled
+ *        Tiled to update.
+ */
+void tiled_build_row_runs(MemZone *memory_pool, Tiled *tiled);
+
 /**
  * @brief Render a Tiled map using software rendering. Use this method for constant timing, or maps
  * that have lots of different tiles.
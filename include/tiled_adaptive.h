@@ -0,0 +1,99 @@
+#pragma once
+
+#include <libdragon.h>
+#include "mem_pool.h"
+#include "rect.h"
+#include "tiled.h"
+#include "tiled_cached.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef TILED_ADAPTIVE_LOAD_COST
+/// Cost of loading a texture, compared to going through a tile that is not drawn.
+#define TILED_ADAPTIVE_LOAD_COST 8
+#endif
+
+/**
+ * @brief How a TiledAdaptive frame was drawn.
+ */
+typedef enum {
+	/// Row by row, loading the texture whenever the tile changes (same as 'tiled_render_rdp').
+	TILED_ADAPTIVE_ROWS,
+	/// Grouped by tile, loading each texture once (same as 'tiled_cached_render').
+	TILED_ADAPTIVE_GROUPED,
+} TiledAdaptiveStrategy;
+
+/**
+ * @brief Statistics of a chunk of the map (see 'TILED_CACHED_CHUNK_SIZE').
+ */
+typedef struct {
+	/// Texture loads needed to draw the whole chunk row by row. Scaled down to the part of the
+	/// chunk on the screen when estimating a frame.
+	uint32_t switches;
+	/// Amount of tiles that are not empty.
+	uint32_t tiles;
+} TiledAdaptiveChunk;
+
+/**
+ * @brief Renders a Tiled map (hardware rendering) choosing, on each frame, between drawing row by
+ * row or grouped by tile. Grouping loads fewer textures, but goes through all tiles of the chunks
+ * on the screen (also the ones outside of it), so it is used only when it saves enough loads.
+ */
+typedef struct {
+	/// Map rendered row by row.
+	Tiled *tiled;
+	/// Same map, grouped by tile. Its chunks are the areas the statistics are kept for.
+	TiledCached *cached;
+	/// Statistics of each chunk, in the same order as the chunks of 'cached'.
+	TiledAdaptiveChunk *chunks;
+	/// Last frame each tile was counted on. Used to count the different tiles on the screen.
+	uint32_t *tile_seen;
+	/// Frames rendered.
+	uint32_t frame;
+	/// Texture loads estimated for drawing the last frame row by row.
+	uint32_t rows_loads;
+	/// Texture loads estimated for drawing the last frame grouped by tile.
+	uint32_t grouped_loads;
+} TiledAdaptive;
+
+/**
+ * @brief Allocates and initializes the adaptive renderer for a Tiled map. The statistics are taken
+ * from the map on init, so the map should not change after it.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc', in that case remember to call
+ * 'tiled_adaptive_destroy' to free the memory allocated.
+ * @param tiled
+ *        Tiled to render.
+ *
+ * @return The new TiledAdaptive.
+ */
+TiledAdaptive *tiled_adaptive_init(MemZone *memory_pool, Tiled *tiled);
+
+/**
+ * @brief Render the map using hardware rendering, with the strategy that costs less for the chunks
+ * on the screen.
+ *
+ * @param adaptive
+ *        TiledAdaptive to render.
+ * @param screen_rect
+ *        Rect of the current screen. Used to cull tiles outside of the screen.
+ *
+ * @return The strategy used to draw the frame.
+ */
+TiledAdaptiveStrategy tiled_adaptive_render_rdp(TiledAdaptive *adaptive, Rect screen_rect);
+
+/**
+ * @brief Destroy a TiledAdaptive created when not using a memory pool. Do not call this function
+ * if using a memory pool. Does not destroy the Tiled map.
+ *
+ * @param adaptive
+ *        TiledAdaptive to destroy.
+ */
+void tiled_adaptive_destroy(TiledAdaptive *adaptive);
+
+#ifdef __cplusplus
+}
+#endif
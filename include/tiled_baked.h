@@ -0,0 +1,115 @@
+#pragma once
+
+#include <libdragon.h>
+#include "mem_pool.h"
+#include "rect.h"
+#include "tiled.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Size of the texture memory of the RDP. Each draw of a baked chunk loads up to this many bytes.
+#define TILED_BAKED_TMEM_SIZE 4096
+
+/**
+ * @brief A block of the map drawn (baked) into a texture.
+ */
+typedef struct {
+	/// Pixels of the chunk. Split in horizontal slices that fit the texture memory.
+	sprite_t *sprite;
+	/// Position of the chunk in chunks. -1 if the slot is empty.
+	int chunk_x;
+	/// Position of the chunk in chunks. -1 if the slot is empty.
+	int chunk_y;
+	/// Last frame the chunk was drawn. Used to choose which chunk to replace.
+	uint32_t last_used;
+	/// True if the chunk has no tiles, so nothing is drawn.
+	bool empty;
+} TiledBakedChunk;
+
+/**
+ * @brief Renders a static Tiled map (hardware rendering) from blocks of tiles that are baked into
+ * textures, so each block is drawn with one rectangle per texture load instead of one per tile.
+ * Only the chunks near the screen are kept, replacing the least recently used ones.
+ */
+typedef struct {
+	/// Map rendered.
+	Tiled *tiled;
+	/// Baked chunks.
+	TiledBakedChunk *chunks;
+	/// Amount of chunks that can be baked at the same time.
+	size_t chunk_count;
+	/// Size of each chunk in tiles.
+	Size chunk_size;
+	/// Size of each chunk in pixels.
+	Size chunk_pixels;
+	/// Height in pixels of each slice of a chunk loaded to the texture memory.
+	int slice_height;
+	/// Amount of chunks on each row of the map.
+	size_t chunks_per_row;
+	/// Amount of chunks on each column of the map.
+	size_t chunks_per_column;
+	/// Amount of chunks that can be baked each frame.
+	size_t bakes_per_frame;
+	/// Frames rendered. Used to know which chunks were used recently.
+	uint32_t frame;
+} TiledBaked;
+
+/**
+ * @brief Allocates and initializes the baked chunks of a Tiled map. No chunks are baked until the
+ * map is rendered.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc', in that case remember to call
+ * 'tiled_baked_destroy' to free the memory allocated.
+ * @param tiled
+ *        Tiled to render. Its sprite has to be 16 or 32 bits (aborts otherwise).
+ * @param chunk_size
+ *        Size of each chunk in tiles. The size in pixels has to be a power of two on both axes
+ * (eg.: 4x4 tiles of 16x16 pixels is a 64x64 pixels chunk). Chunks bigger than the texture memory
+ * are drawn in slices (64x64 pixels at 16 bits is drawn as 2 slices of 64x32).
+ * @param chunk_count
+ *        Amount of chunks baked at the same time. Has to be enough for all chunks visible on the
+ * screen (eg.: 6x5 chunks of 64x64 pixels for a 320x240 screen).
+ * @param bakes_per_frame
+ *        Maximum amount of chunks baked on each frame. Visible chunks that are not baked yet are
+ * rendered tile by tile.
+ *
+ * @return The new TiledBaked.
+ */
+TiledBaked *tiled_baked_init(MemZone *memory_pool, Tiled *tiled, Size chunk_size,
+							 size_t chunk_count, size_t bakes_per_frame);
+
+/**
+ * @brief Discards all baked chunks, so they are baked again from the map. Call it after changing
+ * tiles of the map.
+ *
+ * @param baked
+ *        TiledBaked to discard.
+ */
+void tiled_baked_invalidate(TiledBaked *baked);
+
+/**
+ * @brief Bakes the visible chunks that are missing (up to 'bakes_per_frame') and renders the map
+ * using hardware rendering.
+ *
+ * @param baked
+ *        TiledBaked to render.
+ * @param screen_rect
+ *        Rect of the current screen. Used to cull chunks outside of the screen.
+ */
+void tiled_baked_render_rdp(TiledBaked *baked, Rect screen_rect);
+
+/**
+ * @brief Destroy a TiledBaked created when not using a memory pool. Do not call this function if
+ * using a memory pool. Does not destroy the Tiled map.
+ *
+ * @param baked
+ *        TiledBaked to destroy.
+ */
+void tiled_baked_destroy(TiledBaked *baked);
+
+#ifdef __cplusplus
+}
+#endif
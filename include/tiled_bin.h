@@ -0,0 +1,68 @@
+/**
+ * @file tiled_bin.h
+ * @brief Binary ("cooked") map format loaded by 'tiled_init_bin' and 'tiled_cached_init_bin'.
+ *
+ * Maps are converted from Tiled CSV/TMX files on the host by 'tools/tiled_convert.c'. The file is
+ * a TiledBinHeader followed by the tiles of every layer (layer by layer, row by row), so loading
+ * is a single read with no parsing. All values are big-endian, like the N64.
+ *
+ * Chunked files (TILED_BIN_FLAG_CHUNKED) store each layer as chunks of chunk_width x chunk_height
+ * tiles instead, chunk row by chunk row, each chunk row by row. Chunks on the right and bottom
+ * edges are padded with empty tiles, so every chunk has the same size and can be read with a
+ * single seek. Used by 'tiled_stream_init'.
+ *
+ * This header does not depend on libdragon so it can be used by host tools.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Magic number at the start of every binary map ("TMAP").
+#define TILED_BIN_MAGIC 0x544D4150
+/// Current version of the format. Files with a different version are not loaded.
+#define TILED_BIN_VERSION 1
+
+/// Flag set when the tiles are stored in chunks (see 'TiledBinHeader.chunk_width').
+#define TILED_BIN_FLAG_CHUNKED (1 << 0)
+
+/**
+ * @brief Header of a binary map. Has 32 bytes.
+ */
+typedef struct {
+	/// Always TILED_BIN_MAGIC.
+	uint32_t magic;
+	/// Version of the format used to write the file (TILED_BIN_VERSION).
+	uint16_t version;
+	/// TILED_BIN_FLAG_* flags.
+	uint16_t flags;
+	/// Width of the map in tiles.
+	uint16_t width;
+	/// Height of the map in tiles.
+	uint16_t height;
+	/// Width of each tile in pixels.
+	uint16_t tile_width;
+	/// Height of each tile in pixels.
+	uint16_t tile_height;
+	/// Amount of layers on the file.
+	uint16_t layer_count;
+	/// Size of each tile index in bytes (1 or 2, see 'tiled_tile.h'). Empty tiles have all bits
+	/// set.
+	uint8_t index_bytes;
+	/// Reserved for future use. Always zero.
+	uint8_t reserved;
+	/// Width of each chunk in tiles. Only used if TILED_BIN_FLAG_CHUNKED is set.
+	uint16_t chunk_width;
+	/// Height of each chunk in tiles. Only used if TILED_BIN_FLAG_CHUNKED is set.
+	uint16_t chunk_height;
+	/// Reserved for future use. Always zero.
+	uint8_t reserved2[8];
+} TiledBinHeader;
+
+#ifdef __cplusplus
+}
+#endif
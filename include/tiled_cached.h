@@ -4,25 +4,51 @@
 #include "mem_pool.h"
 #include "rect.h"
 #include "position_int.h"
+#include "tiled_tile.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifndef TILED_CACHED_CHUNK_SIZE
+/// Size (in tiles) of the square areas of the map that are culled together when rendering.
+#define TILED_CACHED_CHUNK_SIZE 16
+#endif
+
 /**
- * @brief Struct the positions of a single tile type.
+ * @brief Struct the positions of a single tile type inside a chunk.
  */
 typedef struct {
+	/// Tile as it is in the map file.
+	tiled_index_t tile;
+	/// Amount of positions.
 	size_t count;
+	/// Positions of the tile on the map, in tiles.
 	PositionInt *position;
 } TiledCachedTile;
 
+/**
+ * @brief Struct the tiles of a square area (TILED_CACHED_CHUNK_SIZE) of the map.
+ */
+typedef struct {
+	/// Tiles used on the chunk, sorted by tile.
+	TiledCachedTile *tiles;
+	/// Amount of different tiles used on the chunk.
+	size_t tile_count;
+} TiledCachedChunk;
+
 /**
  * @brief Struct that holds a TiledCached map.
  */
 typedef struct {
-	/// All tiles cached. The index is the tile as it is in the CSV file.
-	TiledCachedTile tiles[255];
+	/// Chunks of the map, row by row.
+	TiledCachedChunk *chunks;
+	/// Amount of chunks on each row of the map.
+	size_t chunks_per_row;
+	/// Amount of chunks on each column of the map.
+	size_t chunks_per_column;
+	/// Amount of tile types, up to the highest one used on the map.
+	size_t tile_count;
 	/// Size of the map in tiles.
 	Size map_size;
 	/// Size of a tile.
@@ -36,7 +62,8 @@ typedef struct {
  *
  * @param memory_pool
  *        MemZone to use to allocate. If NULL will use malloc instead, call 'tiled_cached_destroy'
- * if you do.
+ * if you do. Memory used while loading is taken from the top of the pool (see
+ * 'mem_zone_alloc_top'), so its current chunk needs room for it. Aborts if there is not enough.
  * @param sprite
  *        Sprite used to render.
  * @param map_path
@@ -51,10 +78,52 @@ typedef struct {
 TiledCached *tiled_cached_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path,
 							   Size map_size, Size tile_size);
 
+/**
+ * @brief Allocates, loads, and initializes the TiledCached map from a binary map (see
+ * 'tiled_bin.h'). Map and tile sizes are read from the file. Only the first layer is loaded.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use malloc instead, call 'tiled_cached_destroy'
+ * if you do. Memory used while loading is taken from the top of the pool (see
+ * 'mem_zone_alloc_top'), so its current chunk needs room for it. Aborts if there is not enough.
+ * @param sprite
+ *        Sprite used to render.
+ * @param map_path
+ *        Path to the binary map file (eg.: "/maps/my_map.bin"), created with 'tiled_convert'.
+ *
+ * @return The new TiledCached.
+ */
+TiledCached *tiled_cached_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path);
+
+/**
+ * @brief Allocates and initializes the TiledCached map from tiles already in memory (eg.: the map
+ * of a 'Tiled').
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use malloc instead, call 'tiled_cached_destroy'
+ * if you do. Memory used while loading is taken from the top of the pool (see
+ * 'mem_zone_alloc_top'), so its current chunk needs room for it. Aborts if there is not enough.
+ * @param sprite
+ *        Sprite used to render.
+ * @param map
+ *        Tiles of the map, row by row. Empty tiles are TILED_EMPTY_TILE. Not used after init.
+ * @param map_size
+ *        Size of the map in tiles.
+ * @param tile_size
+ *        Size of each tile.
+ *
+ * @return The new TiledCached.
+ */
+TiledCached *tiled_cached_init_map(MemZone *memory_pool, sprite_t *sprite,
+								   const tiled_index_t *map, Size map_size, Size tile_size);
+
 /**
  * @brief Render a Tiled map using hardware rendering. Use this method when there aren't that many
  * different tiles, but they are more spread out. See 'Tiled' for other use-cases.
  *
+ * Only the chunks that touch the screen are visited, and each tile texture is loaded once for all
+ * of them.
+ *
  * @param tiled
  *        TiledCached to render.
  * @param screen_rect
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <libdragon.h>
+#include "mem_pool.h"
+#include "rect.h"
+#include "tiled_tile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A single layer of a TiledLayered map.
+ */
+typedef struct {
+	/// Layer data. Has the same size as the map. Empty tiles are TILED_EMPTY_TILE.
+	tiled_index_t *map;
+	/// How fast the layer scrolls compared to the screen (1 is the same speed, 0.5 is half the
+	/// speed, 0 is fixed on the screen). Default is 1.
+	Position scroll_factor;
+	/// If false the layer is not rendered. Default is true.
+	bool visible;
+	/// Spans of non-empty tiles of each row, so rendering skips empty tiles.
+	TiledRowRuns row_runs;
+} TiledLayer;
+
+/**
+ * @brief Struct that holds a Tiled map with multiple layers that share the same sprite.
+ */
+typedef struct {
+	/// Layers of the map, in the same order as the file.
+	TiledLayer *layers;
+	/// Amount of layers.
+	size_t layer_count;
+	/// Size of the map in tiles.
+	Size map_size;
+	/// Size of each tile.
+	Size tile_size;
+	/// Sprite used to render.
+	sprite_t *sprite;
+} TiledLayered;
+
+/**
+ * @brief Allocates, loads, and initializes all layers of a binary map (see 'tiled_bin.h'). All
+ * layers are read at once into a single allocation.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc', in that case remember to call
+ * 'tiled_layered_destroy' to free the memory allocated.
+ * @param sprite
+ *        Sprite used to render all layers.
+ * @param map_path
+ *        Path to the binary map file (eg.: "/maps/my_map.bin"), created with 'tiled_convert'.
+ *
+ * @return The new TiledLayered.
+ */
+TiledLayered *tiled_layered_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path);
+
+/**
+ * @brief Finds the non-empty tiles of each row of a layer again. Already called on init, only call
+ * this after changing empty tiles of the layer to non-empty ones (otherwise they are not rendered).
+ *
+ * @param memory_pool
+ *        Same MemZone used on init (or NULL if not using one). When using a memory pool, the new
+ * spans are allocated from it again, so avoid calling this often.
+ * @param tiled
+ *        TiledLayered to update.
+ * @param layer
+ *        Index of the layer to update.
+ */
+void tiled_layered_build_row_runs(MemZone *memory_pool, TiledLayered *tiled, size_t layer);
+
+/**
+ * @brief Render a range of layers using hardware rendering, from 'first_layer' up to (but not
+ * including) 'first_layer + layer_count'. Layers are rendered in order, sharing the culling (for
+ * layers with the same scroll factor) and the texture loaded.
+ *
+ * Call it more than once to draw other things between layers (eg.: background layers, then the
+ * player, then foreground layers).
+ *
+ * @param tiled
+ *        TiledLayered to render.
+ * @param screen_rect
+ *        Rect of the current screen. Used to cull tiles outside of the screen.
+ * @param first_layer
+ *        First layer to render.
+ * @param layer_count
+ *        Amount of layers to render.
+ */
+void tiled_layered_render_rdp(TiledLayered *tiled, Rect screen_rect, size_t first_layer,
+							  size_t layer_count);
+
+/**
+ * @brief Destroy a TiledLayered created when not using a memory pool. Do not call this function if
+ * using a memory pool.
+ *
+ * @param tiled
+ *        TiledLayered to destroy.
+ */
+void tiled_layered_destroy(TiledLayered *tiled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <libdragon.h>
+#include "mem_pool.h"
+#include "rect.h"
+#include "tiled_tile.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief A chunk of the map that is loaded in memory.
+ */
+typedef struct {
+	/// Tiles of the chunk, row by row.
+	tiled_index_t *tiles;
+	/// Position of the chunk in chunks. -1 if the slot is empty.
+	int chunk_x;
+	/// Position of the chunk in chunks. -1 if the slot is empty.
+	int chunk_y;
+	/// Last frame the chunk was needed. Used to choose which chunk to replace.
+	uint32_t last_used;
+} TiledStreamChunk;
+
+/**
+ * @brief Struct that holds a Tiled map that is streamed from the filesystem in chunks, so only the
+ * chunks around the screen are in memory.
+ */
+typedef struct {
+	/// Chunks currently in memory.
+	TiledStreamChunk *chunks;
+	/// Amount of chunks that can be in memory at the same time.
+	size_t chunk_count;
+	/// Size of the map in tiles.
+	Size map_size;
+	/// Size of each tile.
+	Size tile_size;
+	/// Size of each chunk in tiles.
+	Size chunk_size;
+	/// Amount of chunks on each row of the map.
+	size_t chunks_per_row;
+	/// Amount of chunks on each column of the map.
+	size_t chunks_per_column;
+	/// Amount of chunks that can be loaded each frame.
+	size_t loads_per_frame;
+	/// Distance (in pixels) outside of the screen where chunks start being loaded.
+	int prefetch_margin;
+	/// Frames rendered. Used to know which chunks were used recently.
+	uint32_t frame;
+	/// File of the map. Kept open while the map is used.
+	int fp;
+	/// Sprite used to render.
+	sprite_t *sprite;
+	/// MemZone used on init (NULL if malloc was used).
+	MemZone *memory_pool;
+} TiledStream;
+
+/**
+ * @brief Allocates and initializes a streamed Tiled map. No chunks are loaded until the map is
+ * rendered (or 'tiled_stream_preload' is called).
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc'.
+ * @param sprite
+ *        Sprite used to render.
+ * @param map_path
+ *        Path to the binary map file, created with 'tiled_convert' using chunks ('-c WxH'). Only
+ * the first layer is used.
+ * @param chunk_count
+ *        Amount of chunks in memory at the same time. Has to be enough for all chunks visible on
+ * the screen plus the prefetch margin (eg.: 3x3 chunks when chunks are bigger than the screen).
+ * @param loads_per_frame
+ *        Maximum amount of chunks loaded on each frame, so loading never stalls a frame.
+ * @param prefetch_margin
+ *        Distance (in pixels) outside of the screen where chunks start being loaded, so they are
+ * ready before being visible.
+ *
+ * @return The new TiledStream.
+ */
+TiledStream *tiled_stream_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path,
+							   size_t chunk_count, size_t loads_per_frame, int prefetch_margin);
+
+/**
+ * @brief Loads all chunks visible on 'screen_rect' right away, ignoring the per-frame limit. Use
+ * this before the first frame or after moving the camera to a different place of the map.
+ *
+ * @param tiled
+ *        TiledStream to load.
+ * @param screen_rect
+ *        Rect of the screen.
+ */
+void tiled_stream_preload(TiledStream *tiled, Rect screen_rect);
+
+/**
+ * @brief Loads the chunks around the screen (up to 'loads_per_frame', visible ones first) and
+ * renders the map using hardware rendering. Visible chunks that are not loaded yet are skipped.
+ *
+ * @param tiled
+ *        TiledStream to render.
+ * @param screen_rect
+ *        Rect of the current screen. Used to cull tiles and choose chunks to load.
+ */
+void tiled_stream_render_rdp(TiledStream *tiled, Rect screen_rect);
+
+/**
+ * @brief Closes the map file and frees the TiledStream. Always call this function, even if using a
+ * memory pool (memory is only freed if not using one).
+ *
+ * @param tiled
+ *        TiledStream to destroy.
+ */
+void tiled_stream_destroy(TiledStream *tiled);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <libdragon.h>
+#include "mem_pool.h"
+#include "rect.h"
+#include "position_int.h"
+#include "tiled.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Maximum amount of dirty tiles per frame. If more are marked, the whole surface is redrawn.
+#define TILED_SURFACE_MAX_DIRTY 32
+
+/**
+ * @brief Renders a Tiled map (software rendering) to an offscreen sprite that is kept between
+ * frames. When the screen moves, the old pixels are moved and only the tiles that became visible
+ * (and the ones marked as dirty) are drawn.
+ */
+typedef struct {
+	/// Map rendered.
+	Tiled *tiled;
+	/// Offscreen surface, with the size of the screen and the bit depth of the map sprite.
+	sprite_t *surface;
+	/// Position of the surface on the map (in pixels) on the last render.
+	int x, y;
+	/// If false the whole surface is drawn on the next render.
+	bool valid;
+	/// Amount of tiles on 'dirty'.
+	size_t dirty_count;
+	/// Tiles that will be drawn again on the next render.
+	PositionInt dirty[TILED_SURFACE_MAX_DIRTY];
+} TiledSurface;
+
+/**
+ * @brief Allocates and initializes the offscreen surface for the Tiled map.
+ *
+ * @param memory_pool
+ *        MemZone to use to allocate. If NULL will use 'malloc', in that case remember to call
+ * 'tiled_surface_destroy' to free the memory allocated.
+ * @param tiled
+ *        Tiled to render. Its sprite has to be 16 or 32 bits (aborts otherwise).
+ * @param screen_size
+ *        Size of the screen rect that will be rendered.
+ *
+ * @return The new TiledSurface.
+ */
+TiledSurface *tiled_surface_init(MemZone *memory_pool, Tiled *tiled, Size screen_size);
+
+/**
+ * @brief Marks a tile to be drawn again on the next render. Call it after changing a tile of the
+ * map.
+ *
+ * @param surface
+ *        TiledSurface of the map.
+ * @param tile_x
+ *        Position of the tile on the map, in tiles.
+ * @param tile_y
+ *        Position of the tile on the map, in tiles.
+ */
+void tiled_surface_mark_dirty(TiledSurface *surface, int tile_x, int tile_y);
+
+/**
+ * @brief Makes the whole surface be drawn on the next render.
+ *
+ * @param surface
+ *        TiledSurface to redraw.
+ */
+void tiled_surface_invalidate(TiledSurface *surface);
+
+/**
+ * @brief Updates the surface (moving it by the distance the screen moved since the last render)
+ * and draws it on the screen at the position of 'screen_rect'.
+ *
+ * @param disp
+ *        Display Context to render to.
+ * @param surface
+ *        TiledSurface to render.
+ * @param screen_rect
+ *        Rect of the current screen. Has to be the same size used on init.
+ */
+void tiled_surface_render(display_context_t disp, TiledSurface *surface, Rect screen_rect);
+
+/**
+ * @brief Destroy a TiledSurface created when not using a memory pool. Do not call this function if
+ * using a memory pool. Does not destroy the Tiled map.
+ *
+ * @param surface
+ *        TiledSurface to destroy.
+ */
+void tiled_surface_destroy(TiledSurface *surface);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,52 @@
+/**
+ * @file tiled_tile.h
+ * @brief Type used to store tile indexes on all Tiled maps.
+ *
+ * Tile indexes use 8 bits by default (up to 255 different tiles). Define TILED_INDEX_16BIT on the
+ * whole project to use 16 bits instead (up to 65535 different tiles), at twice the memory per tile.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef TILED_INDEX_16BIT
+/// Index of a tile on the sprite.
+typedef uint16_t tiled_index_t;
+/// Index used for tiles that are not rendered (-1 on CSV files).
+#define TILED_EMPTY_TILE 0xFFFF
+#else
+/// Index of a tile on the sprite.
+typedef uint8_t tiled_index_t;
+/// Index used for tiles that are not rendered (-1 on CSV files).
+#define TILED_EMPTY_TILE 0xFF
+#endif
+
+/// Byte used to fill maps with empty tiles using memset (every bit of TILED_EMPTY_TILE is set).
+#define TILED_EMPTY_BYTE 0xFF
+
+/**
+ * @brief Span of non-empty tiles on a row of a map, from 'start' up to (but not including) 'end'.
+ */
+typedef struct {
+	uint16_t start;
+	uint16_t end;
+} TiledRun;
+
+/**
+ * @brief Spans of non-empty tiles of every row of a map, so renderers can skip empty tiles.
+ */
+typedef struct {
+	/// Spans of all rows, row by row.
+	TiledRun *runs;
+	/// Index of the first span of each row on 'runs'. Has one entry per row plus one.
+	uint32_t *row_first;
+} TiledRowRuns;
+
+#ifdef __cplusplus
+}
+#endif
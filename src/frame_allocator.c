@@ -0,0 +1,39 @@
+#include "../include/frame_allocator.h"
+#include "../include/memory_alloc.h"
+
+FrameAllocator *frame_allocator_init(MemZone *memory_pool, size_t size_per_frame) {
+	// keeps both halves aligned the same way as the allocations
+	size_per_frame = (size_per_frame + 15) & ~(size_t)15;
+
+	FrameAllocator *frame_allocator = MEM_ALLOC(sizeof(FrameAllocator), memory_pool);
+	char *buffer = MEM_ALLOC(size_per_frame * 2, memory_pool);
+	if (buffer == NULL) {
+		abort();  // Put your error handling here.
+	}
+
+	mem_zone_init_buffer(&frame_allocator->zones[0], buffer, size_per_frame, MEM_ZONE_NO_CLEAR);
+	mem_zone_init_buffer(&frame_allocator->zones[1], buffer + size_per_frame, size_per_frame,
+						 MEM_ZONE_NO_CLEAR);
+	frame_allocator->current = 0;
+
+	return frame_allocator;
+}
+
+void *frame_allocator_alloc(FrameAllocator *frame_allocator, size_t size) {
+	return mem_zone_alloc(&frame_allocator->zones[frame_allocator->current], size);
+}
+
+void frame_allocator_flip(FrameAllocator *frame_allocator) {
+	frame_allocator->current ^= 1;
+	mem_zone_free_all(&frame_allocator->zones[frame_allocator->current]);
+}
+
+void frame_allocator_reset(FrameAllocator *frame_allocator) {
+	mem_zone_free_all(&frame_allocator->zones[0]);
+	mem_zone_free_all(&frame_allocator->zones[1]);
+}
+
+void frame_allocator_destroy(FrameAllocator *frame_allocator) {
+	free(frame_allocator->zones[0].start);
+	free(frame_allocator);
+}
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "../include/mem_heap.h"
+
+#include <string.h>
+#include "../include/memory_alloc.h"
+
+#define ALIGN_SIZE (1 << MEM_HEAP_ALIGN_LOG2)
+#define ALIGN_UP(X) (((X) + (ALIGN_SIZE - 1)) & ~(size_t)(ALIGN_SIZE - 1))
+
+// Offset from the block to its memory. Free list pointers can be past it, inside the memory.
+#define BLOCK_HEADER_SIZE ALIGN_UP(offsetof(MemHeapBlock, next_free))
+// Smallest block memory, big enough to hold the free list pointers.
+#define BLOCK_SIZE_MIN ALIGN_UP(sizeof(MemHeapBlock) - BLOCK_HEADER_SIZE + 1)
+#define BLOCK_SIZE_MAX (((size_t)1 << MEM_HEAP_FL_INDEX_MAX) - ALIGN_SIZE)
+
+#define BLOCK_FREE_BIT 1
+
+static inline int mem_heap_fls(size_t x) {
+	return 31 - __builtin_clz((uint32_t)x);
+}
+
+static inline int mem_heap_ffs(uint32_t x) {
+	return __builtin_ctz(x);
+}
+
+static inline size_t block_size(MemHeapBlock *block) {
+	return block->size & ~(size_t)BLOCK_FREE_BIT;
+}
+
+static inline bool block_is_free(MemHeapBlock *block) {
+	return block->size & BLOCK_FREE_BIT;
+}
+
+static inline void *block_to_ptr(MemHeapBlock *block) {
+	return (char *)block + BLOCK_HEADER_SIZE;
+}
+
+static inline MemHeapBlock *block_from_ptr(void *ptr) {
+	return (MemHeapBlock *)((char *)ptr - BLOCK_HEADER_SIZE);
+}
+
+static inline MemHeapBlock *block_next(MemHeapBlock *block) {
+	return (MemHeapBlock *)((char *)block_to_ptr(block) + block_size(block));
+}
+
+// Gets the list where blocks of 'size' are kept.
+static inline void mapping_insert(size_t size, int *fl, int *sl) {
+	if (size < (1 << MEM_HEAP_FL_INDEX_SHIFT)) {
+		*fl = 0;
+		*sl = size >> MEM_HEAP_ALIGN_LOG2;
+	} else {
+		int f = mem_heap_fls(size);
+		*sl = (size >> (f - MEM_HEAP_SL_INDEX_COUNT_LOG2)) ^ MEM_HEAP_SL_INDEX_COUNT;
+		*fl = f - (MEM_HEAP_FL_INDEX_SHIFT - 1);
+	}
+}
+
+// Gets the first list where all blocks are at least 'size' bytes.
+static inline void mapping_search(size_t size, int *fl, int *sl) {
+	if (size >= (1 << MEM_HEAP_FL_INDEX_SHIFT)) {
+		size += (1 << (mem_heap_fls(size) - MEM_HEAP_SL_INDEX_COUNT_LOG2)) - 1;
+	}
+	mapping_insert(size, fl, sl);
+}
+
+// Gets the biggest request that 'mapping_search' puts on the list of a block of 'size'.
+static inline size_t mapping_round_down(size_t size) {
+	if (size >= (1 << MEM_HEAP_FL_INDEX_SHIFT)) {
+		size &= ~(((size_t)1 << (mem_heap_fls(size) - MEM_HEAP_SL_INDEX_COUNT_LOG2)) - 1);
+	}
+	return size;
+}
+
+static MemHeapBlock *mem_heap_find_suitable(MemHeap *heap, int *fl, int *sl) {
+	uint32_t sl_map = heap->sl_bitmap[*fl] & (~0U << *sl);
+	if (!sl_map) {
+		uint32_t fl_map = *fl + 1 < 32 ? heap->fl_bitmap & (~0U << (*fl + 1)) : 0;
+		if (!fl_map) {
+			return NULL;
+		}
+		*fl = mem_heap_ffs(fl_map);
+		sl_map = heap->sl_bitmap[*fl];
+	}
+	*sl = mem_heap_ffs(sl_map);
+	return heap->blocks[*fl][*sl];
+}
+
+static void mem_heap_remove_free(MemHeap *heap, MemHeapBlock *block) {
+	int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	if (block->prev_free) {
+		block->prev_free->next_free = block->next_free;
+	} else {
+		heap->blocks[fl][sl] = block->next_free;
+		if (!block->next_free) {
+			heap->sl_bitmap[fl] &= ~(1U << sl);
+			if (!heap->sl_bitmap[fl]) {
+				heap->fl_bitmap &= ~(1U << fl);
+			}
+		}
+	}
+	if (block->next_free) {
+		block->next_free->prev_free = block->prev_free;
+	}
+	block->size &= ~(size_t)BLOCK_FREE_BIT;
+}
+
+static void mem_heap_insert_free(MemHeap *heap, MemHeapBlock *block) {
+	int fl, sl;
+	mapping_insert(block_size(block), &fl, &sl);
+
+	block->size |= BLOCK_FREE_BIT;
+	block->prev_free = NULL;
+	block->next_free = heap->blocks[fl][sl];
+	if (block->next_free) {
+		block->next_free->prev_free = block;
+	}
+	heap->blocks[fl][sl] = block;
+	heap->fl_bitmap |= 1U << fl;
+	heap->sl_bitmap[fl] |= 1U << sl;
+}
+
+// Splits 'block' (not free) so it has 'size' bytes, returning the rest as a free block.
+static void mem_heap_trim(MemHeap *heap, MemHeapBlock *block, size_t size) {
+	if (block_size(block) < size + BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN) {
+		return;
+	}
+
+	MemHeapBlock *next = block_next(block);
+	MemHeapBlock *rest = (MemHeapBlock *)((char *)block_to_ptr(block) + size);
+	rest->size = block_size(block) - size - BLOCK_HEADER_SIZE;
+	rest->prev_phys = block;
+	block->size = size;
+	next->prev_phys = rest;
+
+	// the block after the rest can be free if the block was shrunk by 'mem_heap_realloc'
+	if (block_is_free(next)) {
+		mem_heap_remove_free(heap, next);
+		rest->size += BLOCK_HEADER_SIZE + block_size(next);
+		block_next(rest)->prev_phys = rest;
+	}
+	mem_heap_insert_free(heap, rest);
+}
+
+// Merges 'block' (not free) with the free block right after it.
+static void mem_heap_absorb_next(MemHeap *heap, MemHeapBlock *block) {
+	MemHeapBlock *next = block_next(block);
+	mem_heap_remove_free(heap, next);
+	block->size += BLOCK_HEADER_SIZE + block_size(next);
+	block_next(block)->prev_phys = block;
+}
+
+static size_t mem_heap_adjust_size(size_t size) {
+	size = ALIGN_UP(size);
+	return size < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : size;
+}
+
+MemHeap *mem_heap_init(MemZone *memory_pool, size_t size) {
+	size = ALIGN_UP(size);
+	if (size < 2 * BLOCK_HEADER_SIZE + BLOCK_SIZE_MIN ||
+		size - 2 * BLOCK_HEADER_SIZE > BLOCK_SIZE_MAX) {
+		abort();  // Heap is too small or too big.
+	}
+
+	MemHeap *heap = MEM_ALLOC(sizeof(MemHeap) + ALIGN_SIZE + size, memory_pool);
+	if (heap == NULL) {
+		abort();  // Put your error handling here.
+	}
+	memset(heap, 0, sizeof(MemHeap));
+	heap->start = (char *)ALIGN_UP((uintptr_t)(heap + 1));
+	heap->end = heap->start + size;
+
+	// a single free block with all the memory, followed by an empty used block that is never merged
+	MemHeapBlock *block = (MemHeapBlock *)heap->start;
+	block->prev_phys = NULL;
+	block->size = size - 2 * BLOCK_HEADER_SIZE;
+
+	MemHeapBlock *sentinel = block_next(block);
+	sentinel->prev_phys = block;
+	sentinel->size = 0;
+
+	mem_heap_insert_free(heap, block);
+
+	return heap;
+}
+
+void *mem_heap_alloc(MemHeap *heap, size_t size) {
+	if (size == 0 || size > BLOCK_SIZE_MAX) {
+		return NULL;
+	}
+	size = mem_heap_adjust_size(size);
+
+	int fl, sl;
+	mapping_search(size, &fl, &sl);
+	if (fl >= MEM_HEAP_FL_INDEX_COUNT) {
+		return NULL;
+	}
+
+	MemHeapBlock *block = mem_heap_find_suitable(heap, &fl, &sl);
+	if (block == NULL) {
+		return NULL;  // Out of memory.
+	}
+
+	mem_heap_remove_free(heap, block);
+	mem_heap_trim(heap, block, size);
+
+	heap->used_bytes += block_size(block);
+	heap->alloc_count++;
+
+	return block_to_ptr(block);
+}
+
+void mem_heap_free(MemHeap *heap, void *ptr) {
+	if (ptr == NULL) {
+		return;
+	}
+
+	MemHeapBlock *block = block_from_ptr(ptr);
+	heap->used_bytes -= block_size(block);
+	heap->alloc_count--;
+
+	// merge with the neighbors that are free
+	MemHeapBlock *prev = block->prev_phys;
+	if (prev && block_is_free(prev)) {
+		mem_heap_remove_free(heap, prev);
+		prev->size += BLOCK_HEADER_SIZE + block_size(block);
+		block_next(prev)->prev_phys = prev;
+		block = prev;
+	}
+	if (block_is_free(block_next(block))) {
+		mem_heap_absorb_next(heap, block);
+	}
+
+	mem_heap_insert_free(heap, block);
+}
+
+void *mem_heap_realloc(MemHeap *heap, void *ptr, size_t size) {
+	if (ptr == NULL) {
+		return mem_heap_alloc(heap, size);
+	}
+	if (size == 0) {
+		mem_heap_free(heap, ptr);
+		return NULL;
+	}
+	if (size > BLOCK_SIZE_MAX) {
+		return NULL;
+	}
+
+	MemHeapBlock *block = block_from_ptr(ptr);
+	size_t current_size = block_size(block);
+	size = mem_heap_adjust_size(size);
+
+	// grow in place if the next block is free and big enough
+	if (size > current_size) {
+		MemHeapBlock *next = block_next(block);
+		if (!block_is_free(next) || current_size + BLOCK_HEADER_SIZE + block_size(next) < size) {
+			void *new_ptr = mem_heap_alloc(heap, size);
+			if (new_ptr) {
+				memcpy(new_ptr, ptr, current_size);
+				mem_heap_free(heap, ptr);
+			}
+			return new_ptr;
+		}
+		mem_heap_absorb_next(heap, block);
+	}
+
+	mem_heap_trim(heap, block, size);
+	heap->used_bytes += block_size(block) - current_size;
+
+	return ptr;
+}
+
+void mem_heap_get_stats(MemHeap *heap, MemHeapStats *stats) {
+	memset(stats, 0, sizeof(MemHeapStats));
+	stats->used_bytes = heap->used_bytes;
+	stats->alloc_count = heap->alloc_count;
+
+	for (MemHeapBlock *block = (MemHeapBlock *)heap->start; block_size(block) > 0;
+		 block = block_next(block)) {
+		if (block_is_free(block)) {
+			stats->free_bytes += block_size(block);
+			stats->free_block_count++;
+			if (block_size(block) > stats->largest_free_block) {
+				stats->largest_free_block = block_size(block);
+			}
+		}
+	}
+
+	if (stats->largest_free_block >= BLOCK_SIZE_MIN) {
+		stats->largest_alloc = mapping_round_down(stats->largest_free_block);
+	}
+
+	if (stats->free_bytes > 0) {
+		stats->fragmentation = 1.f - (stats->largest_free_block / (float)stats->free_bytes);
+	}
+}
+
+void mem_heap_destroy(MemHeap *heap) {
+	free(heap);
+}
\ No newline at end of file
@@ -1,42 +1,519 @@
 #include "../include/mem_pool.h"
 
+#include <assert.h>
+#include <stdbool.h>
 #include <string.h>
 
 #include <libdragon.h>
 
+// Keeps chunk memory aligned the same way as the allocations.
+#define CHUNK_HEADER_SIZE ((sizeof(MemZoneChunk) + 15) & ~(size_t)15)
+
+static char *mem_zone_chunk_start(MemZoneChunk *chunk) {
+	return (char *)chunk + CHUNK_HEADER_SIZE;
+}
+
+#ifdef MEM_ZONE_GUARD
+#define GUARD_MAGIC 0xF00DCAFE
+
+// Written right after every allocation. If it changes, something wrote past the allocation.
+typedef struct {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t size_check;
+	uint32_t magic_end;
+} MemZoneGuard;
+
+static void mem_zone_guard_write(char *pos, size_t size) {
+	MemZoneGuard *guard = (MemZoneGuard *)pos;
+	guard->magic = GUARD_MAGIC;
+	guard->size = size;
+	guard->size_check = ~(uint32_t)size;
+	guard->magic_end = GUARD_MAGIC;
+}
+
+// Checks the guard of the allocation that ends at 'pos' and starts after 'begin'.
+static MemZoneGuard *mem_zone_guard_validate(char *begin, char *pos) {
+	MemZoneGuard *guard = (MemZoneGuard *)(pos - sizeof(MemZoneGuard));
+	if (guard->magic != GUARD_MAGIC || guard->magic_end != GUARD_MAGIC ||
+		guard->size_check != ~guard->size || guard->size > (size_t)((char *)guard - begin)) {
+		abort();  // Memory was written past the end of an allocation.
+	}
+	return guard;
+}
+
+// Walks the allocations in [begin, end) from the last one, checking their guards, then poisons it.
+static void mem_zone_guard_check(char *begin, char *end) {
+	char *pos = end;
+	while (pos > begin) {
+		MemZoneGuard *guard = mem_zone_guard_validate(begin, pos);
+		pos = (char *)guard - guard->size;
+	}
+
+	memset(begin, MEM_ZONE_POISON, end - begin);
+}
+
+// Checks and poisons everything allocated after 'pos' on 'chunk' (NULL being the initial block).
+static void mem_zone_guard_release(MemZone *z, MemZoneChunk *chunk, char *pos) {
+	MemZoneChunk *current = z->chunk;
+	char *end = z->pos;
+	while (current != chunk) {
+		mem_zone_guard_check(mem_zone_chunk_start(current), end);
+		end = current->prev_pos;
+		current = current->prev;
+	}
+	mem_zone_guard_check(pos, end);
+}
+#endif
+
+static bool mem_zone_grow(MemZone *z, size_t size) {
+	if (z->chunk_size == 0) {
+		return false;
+	}
+
+	size_t chunk_size = size > z->chunk_size ? size : z->chunk_size;
+	if (z->max_size && z->total_size + chunk_size > z->max_size) {
+		return false;
+	}
+
+	MemZoneChunk *chunk = malloc(CHUNK_HEADER_SIZE + chunk_size);
+	if (chunk == NULL) {
+		return false;
+	}
+	chunk->prev = z->chunk;
+	chunk->end = mem_zone_chunk_start(chunk) + chunk_size;
+	chunk->prev_pos = z->pos;
+
+	z->chunk = chunk;
+	z->pos = mem_zone_chunk_start(chunk);
+	z->limit = chunk->end;
+	z->total_size += chunk_size;
+
+	return true;
+}
+
+// Frees chunks until 'target' is the current one.
+static void mem_zone_release_chunks(MemZone *z, MemZoneChunk *target) {
+	while (z->chunk != target) {
+		MemZoneChunk *prev = z->chunk->prev;
+		z->total_size -= z->chunk->end - mem_zone_chunk_start(z->chunk);
+		free(z->chunk);
+		z->chunk = prev;
+	}
+	z->limit = z->chunk ? z->chunk->end : z->top;
+}
+
+// Lowest address the top of the zone can grow down to.
+static char *mem_zone_top_floor(MemZone *z) {
+	if (z->chunk == NULL) {
+		return z->pos;
+	}
+
+	// the initial block stopped being used by the bottom when the first chunk was allocated
+	MemZoneChunk *first = z->chunk;
+	while (first->prev) {
+		first = first->prev;
+	}
+	return first->prev_pos;
+}
+
+static void mem_zone_overflow(MemZone *z, size_t requested) {
+#ifdef MEM_ZONE_STATS
+	z->stats.failed_count++;
+#endif
+	if (z->overflow_callback) {
+		z->overflow_callback(z, requested);
+	}
+}
+
+#ifdef MEM_ZONE_STATS
+// Bytes lost when rounding 'requested' up to 16 bytes.
+static inline size_t mem_zone_waste(size_t requested) {
+	return ((requested + 15) & ~(size_t)15) - requested;
+}
+
+static void mem_zone_stats_add(MemZone *z, size_t size, size_t requested, uint8_t tag, bool top) {
+	size_t wasted = mem_zone_waste(requested);
+
+	z->stats.current_bytes += size;
+	if (z->stats.current_bytes > z->stats.peak_bytes) {
+		z->stats.peak_bytes = z->stats.current_bytes;
+	}
+	z->stats.alloc_count++;
+	z->stats.wasted_bytes += wasted;
+	// tags out of range are only counted on the totals
+	if (tag < MEM_ZONE_STATS_MAX_TAGS) {
+		z->stats.tag_bytes[tag] += requested;
+	}
+
+	if (top) {
+		z->stats.top_bytes += size;
+		z->stats.top_count++;
+		z->stats.top_wasted_bytes += wasted;
+	}
+}
+
+// Saves the counters of one side of the zone on the marker.
+static void mem_zone_stats_mark(MemZone *z, MemZoneMarker *marker, bool top) {
+	marker->current_bytes = z->stats.top_bytes;
+	marker->alloc_count = z->stats.top_count;
+	marker->wasted_bytes = z->stats.top_wasted_bytes;
+	if (!top) {
+		marker->current_bytes = z->stats.current_bytes - marker->current_bytes;
+		marker->alloc_count = z->stats.alloc_count - marker->alloc_count;
+		marker->wasted_bytes = z->stats.wasted_bytes - marker->wasted_bytes;
+	}
+}
+
+// Sets the counters of one side of the zone, keeping the other side as it is.
+static void mem_zone_stats_restore(MemZone *z, size_t bytes, size_t count, size_t wasted,
+								   bool top) {
+	if (top) {
+		z->stats.current_bytes = z->stats.current_bytes - z->stats.top_bytes + bytes;
+		z->stats.alloc_count = z->stats.alloc_count - z->stats.top_count + count;
+		z->stats.wasted_bytes = z->stats.wasted_bytes - z->stats.top_wasted_bytes + wasted;
+		z->stats.top_bytes = bytes;
+		z->stats.top_count = count;
+		z->stats.top_wasted_bytes = wasted;
+	} else {
+		z->stats.current_bytes = z->stats.top_bytes + bytes;
+		z->stats.alloc_count = z->stats.top_count + count;
+		z->stats.wasted_bytes = z->stats.top_wasted_bytes + wasted;
+	}
+}
+#endif
+
 void mem_zone_init(MemZone *z, size_t size) {
-	disable_interrupts();
+	mem_zone_init_buffer(z, NULL, size, MEM_ZONE_DEFAULT);
+}
 
-	void *ptr = malloc(size);
-	if (ptr == NULL) {
-		abort();  // Put your error handling here.
+void mem_zone_init_buffer(MemZone *z, void *buffer, size_t size, MemZoneFlags flags) {
+	z->owns_memory = buffer == NULL;
+	if (buffer == NULL) {
+		disable_interrupts();
+		buffer = malloc(size);
+		enable_interrupts();
+
+		if (buffer == NULL) {
+			abort();  // Put your error handling here.
+		}
 	}
-	z->pos = (char *)ptr;
+	z->pos = (char *)buffer;
 	z->start = z->pos;
 	z->end = z->start + size;
+	z->top = z->end;
+	z->limit = z->top;
+	z->marker_depth = 0;
+	z->top_marker_depth = 0;
+	z->marker_serial = 0;
+	memset(z->marker_serials, 0, sizeof(z->marker_serials));
+	memset(z->top_marker_serials, 0, sizeof(z->top_marker_serials));
+	z->last = NULL;
+	z->last_size = 0;
+	z->chunk = NULL;
+	z->chunk_size = 0;
+	z->max_size = 0;
+	z->total_size = size;
+	z->overflow_callback = NULL;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_reset(z);
+#endif
 
-	memset(z->start, 0, size);
+	if (!(flags & MEM_ZONE_NO_CLEAR)) {
+		memset(z->start, 0, size);
+	}
+}
 
-	enable_interrupts();
+void mem_zone_init_chained(MemZone *z, size_t size, size_t chunk_size, size_t max_size) {
+	mem_zone_init_buffer(z, NULL, size, MEM_ZONE_DEFAULT);
+	z->chunk_size = chunk_size;
+	z->max_size = max_size;
 }
 
-void *mem_zone_alloc(MemZone *z, size_t size) {
+static inline void *mem_zone_alloc_internal(MemZone *z, size_t size, uint8_t tag) {
 	if (size == 0) {
 		return NULL;
 	}
+	size_t requested = size;
 	// Round up to multiple of 16 bytes.
 	size = (size + 15) & ~(size_t)15;
+#ifdef MEM_ZONE_GUARD
+	size_t data_size = size;
+	size += sizeof(MemZoneGuard);
+#endif
 	// How much free space remaining in zone?
-	size_t rem = z->end - z->pos;
-	if (rem < size) {
-		return NULL;  // Out of memory. Put your error handling here.
+	size_t rem = z->limit - z->pos;
+	if (rem < size && !mem_zone_grow(z, size)) {
+		mem_zone_overflow(z, requested);
+		return NULL;  // Out of memory.
 	}
 
 	void *ptr = (void *)z->pos;
 	z->pos += size;
+	z->last = ptr;
+	z->last_size = requested;
+
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_write((char *)ptr + data_size, data_size);
+#endif
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_add(z, size, requested, tag, false);
+#else
+	(void)tag;
+#endif
+
 	return ptr;
 }
 
+void *mem_zone_alloc(MemZone *z, size_t size) {
+	return mem_zone_alloc_internal(z, size, 0);
+}
+
+void *mem_zone_alloc_zeroed(MemZone *z, size_t size) {
+	void *ptr = mem_zone_alloc_internal(z, size, 0);
+	if (ptr) {
+		memset(ptr, 0, size);
+	}
+	return ptr;
+}
+
+void *mem_zone_realloc_last(MemZone *z, void *ptr, size_t size) {
+	if (ptr == NULL) {
+		return mem_zone_alloc_internal(z, size, 0);
+	}
+
+	// only the last allocation can be resized
+	assert(ptr == z->last);
+	if (ptr != z->last) {
+		return NULL;
+	}
+
+#if defined(MEM_ZONE_GUARD) || defined(MEM_ZONE_STATS)
+	size_t old_size = z->pos - z->last;
+#endif
+	size_t old_requested = z->last_size;
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_validate(z->last, z->pos);
+#endif
+
+	if (size == 0) {
+#ifdef MEM_ZONE_GUARD
+		memset(z->last, MEM_ZONE_POISON, old_size);
+#endif
+#ifdef MEM_ZONE_STATS
+		z->stats.current_bytes -= old_size;
+		z->stats.alloc_count--;
+		z->stats.wasted_bytes -= mem_zone_waste(old_requested);
+#endif
+		z->pos = z->last;
+		z->last = NULL;
+		z->last_size = 0;
+		return NULL;
+	}
+
+	size_t new_size = (size + 15) & ~(size_t)15;
+#ifdef MEM_ZONE_GUARD
+	size_t data_size = new_size;
+	new_size += sizeof(MemZoneGuard);
+#endif
+	if ((size_t)(z->limit - z->last) < new_size) {
+		// doesn't fit in place, so move it (only works on chained zones)
+		void *new_ptr = mem_zone_alloc_internal(z, size, 0);
+		if (new_ptr) {
+			memcpy(new_ptr, ptr, old_requested < size ? old_requested : size);
+#ifdef MEM_ZONE_STATS
+			// the old block stays used until the zone is freed, but is not an allocation anymore
+			z->stats.alloc_count--;
+			z->stats.wasted_bytes += old_size - mem_zone_waste(old_requested);
+#endif
+		}
+		return new_ptr;
+	}
+
+	z->pos = z->last + new_size;
+	z->last_size = size;
+
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_write(z->last + data_size, data_size);
+#endif
+#ifdef MEM_ZONE_STATS
+	z->stats.current_bytes = z->stats.current_bytes - old_size + new_size;
+	if (z->stats.current_bytes > z->stats.peak_bytes) {
+		z->stats.peak_bytes = z->stats.current_bytes;
+	}
+	z->stats.wasted_bytes =
+		z->stats.wasted_bytes - mem_zone_waste(old_requested) + mem_zone_waste(size);
+#endif
+
+	return ptr;
+}
+
+void *mem_zone_alloc_top(MemZone *z, size_t size) {
+	if (size == 0) {
+		return NULL;
+	}
+	size_t requested = size;
+	// Round up to multiple of 16 bytes.
+	size = (size + 15) & ~(size_t)15;
+#ifdef MEM_ZONE_GUARD
+	size_t data_size = size;
+	size += sizeof(MemZoneGuard);
+#endif
+	size_t rem = z->top - mem_zone_top_floor(z);
+	if (rem < size) {
+		mem_zone_overflow(z, requested);
+		return NULL;  // Out of memory.
+	}
+
+	z->top -= size;
+	if (z->chunk == NULL) {
+		z->limit = z->top;
+	}
+
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_write(z->top + data_size, data_size);
+#endif
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_add(z, size, requested, 0, true);
+#endif
+
+	return (void *)z->top;
+}
+
+#ifdef MEM_ZONE_STATS
+void *mem_zone_alloc_tagged(MemZone *z, size_t size, uint8_t tag) {
+	return mem_zone_alloc_internal(z, size, tag);
+}
+
+void mem_zone_stats_reset(MemZone *z) {
+	memset(&z->stats, 0, sizeof(MemZoneStats));
+}
+#endif
+
+void mem_zone_set_overflow_callback(MemZone *z, fnMemZoneOverflowCallback callback) {
+	z->overflow_callback = callback;
+}
+
 void mem_zone_free_all(MemZone *z) {
+	mem_zone_free_bottom(z);
+	mem_zone_free_top(z);
+}
+
+void mem_zone_free_bottom(MemZone *z) {
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_release(z, NULL, z->start);
+#endif
+	mem_zone_release_chunks(z, NULL);
 	z->pos = z->start;
+	z->last = NULL;
+	z->marker_depth = 0;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_restore(z, 0, 0, 0, false);
+#endif
+}
+
+void mem_zone_free_top(MemZone *z) {
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_check(z->top, z->end);
+#endif
+	z->top = z->end;
+	if (z->chunk == NULL) {
+		z->limit = z->top;
+	}
+	z->top_marker_depth = 0;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_restore(z, 0, 0, 0, true);
+#endif
+}
+
+void mem_zone_destroy(MemZone *z) {
+	mem_zone_release_chunks(z, NULL);
+	if (z->owns_memory) {
+		free(z->start);
+	}
+	z->pos = z->start = z->end = z->top = z->limit = NULL;
+	z->total_size = 0;
+}
+
+/*
+ * Gives 'marker' a new serial number and saves it on 'serials' (the open markers of one side of the
+ * zone) so a stale marker with the same depth can be told apart.
+ */
+static void mem_zone_marker_open(MemZone *z, MemZoneMarker *marker, uint32_t *serials) {
+	marker->serial = ++z->marker_serial;
+	if (marker->depth <= MEM_ZONE_MARKER_CHECKS) {
+		serials[marker->depth - 1] = marker->serial;
+	}
+}
+
+// If 'marker' is still open (or deeper than the levels checked).
+static inline bool mem_zone_marker_is_open(MemZoneMarker *marker, size_t depth,
+										   const uint32_t *serials) {
+	if (marker->depth == 0 || marker->depth > depth) {
+		return false;
+	}
+	return marker->depth > MEM_ZONE_MARKER_CHECKS || serials[marker->depth - 1] == marker->serial;
+}
+
+MemZoneMarker mem_zone_mark(MemZone *z) {
+	MemZoneMarker marker;
+	marker.pos = z->pos;
+	marker.chunk = z->chunk;
+	marker.depth = ++z->marker_depth;
+	mem_zone_marker_open(z, &marker, z->marker_serials);
+	// the last allocation cannot be resized past the marker
+	z->last = NULL;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_mark(z, &marker, false);
+#endif
+	return marker;
+}
+
+void mem_zone_rewind_to(MemZone *z, MemZoneMarker marker) {
+	// a marker deeper than the zone (or with the serial of another marker) was discarded by an
+	// outer rewind (out of order) or a free_all
+	assert(mem_zone_marker_is_open(&marker, z->marker_depth, z->marker_serials));
+	assert(marker.chunk != z->chunk || marker.pos <= z->pos);
+
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_release(z, marker.chunk, marker.pos);
+#endif
+	mem_zone_release_chunks(z, marker.chunk);
+	z->pos = marker.pos;
+	z->last = NULL;
+	z->marker_depth = marker.depth - 1;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_restore(z, marker.current_bytes, marker.alloc_count, marker.wasted_bytes, false);
+#endif
+}
+
+MemZoneMarker mem_zone_mark_top(MemZone *z) {
+	MemZoneMarker marker;
+	marker.pos = z->top;
+	marker.chunk = NULL;
+	marker.depth = ++z->top_marker_depth;
+	mem_zone_marker_open(z, &marker, z->top_marker_serials);
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_mark(z, &marker, true);
+#endif
+	return marker;
+}
+
+void mem_zone_rewind_top_to(MemZone *z, MemZoneMarker marker) {
+	// a marker deeper than the zone (or with the serial of another marker) was discarded by an
+	// outer rewind (out of order) or a free_top
+	assert(mem_zone_marker_is_open(&marker, z->top_marker_depth, z->top_marker_serials));
+	assert(marker.pos >= z->top && marker.pos <= z->end);
+
+#ifdef MEM_ZONE_GUARD
+	mem_zone_guard_check(z->top, marker.pos);
+#endif
+	z->top = marker.pos;
+	if (z->chunk == NULL) {
+		z->limit = z->top;
+	}
+	z->top_marker_depth = marker.depth - 1;
+#ifdef MEM_ZONE_STATS
+	mem_zone_stats_restore(z, marker.current_bytes, marker.alloc_count, marker.wasted_bytes, true);
+#endif
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ SceneManager *scene_manager_init(MemZone *global_memory_pool, MemZone *scene_mem
 	scene_manager->change_scene_callback = change_scene_callback;
 	scene_manager->current_scene_id = -1;
 	scene_manager->scene_memory_pool = scene_memory_pool;
+	scene_manager->frame_allocator = NULL;
 
 	return scene_manager;
 }
@@ -32,7 +33,15 @@ void scene_manager_set_callbacks(SceneManager *scene_manager, fnSMCreateCallback
 		abort();
 }
 
+void scene_manager_set_frame_allocator(SceneManager *scene_manager,
+									   FrameAllocator *frame_allocator) {
+	scene_manager->frame_allocator = frame_allocator;
+}
+
 void scene_manager_tick(SceneManager *scene_manager) {
+	if (scene_manager->frame_allocator)
+		frame_allocator_flip(scene_manager->frame_allocator);
+
 	// change scene if needed
 	if (scene_manager->current_scene_id != scene_manager->next_scene_id) {
 		if (scene_manager->current_scene_id >= 0) {
@@ -40,6 +49,8 @@ void scene_manager_tick(SceneManager *scene_manager) {
 				scene_manager->scene_callbacks.destroy();
 			if (scene_manager->scene_memory_pool)
 				mem_zone_free_all(scene_manager->scene_memory_pool);
+			if (scene_manager->frame_allocator)
+				frame_allocator_reset(scene_manager->frame_allocator);
 		}
 
 		scene_manager->change_scene_callback(scene_manager->current_scene_id,
@@ -1,25 +1,10 @@
 #include "../include/tiled.h"
 
 #include <string.h>
-
-#define FILE_BUFFER_SIZE 100
-
-#define SET_VARS()                                                                                 \
-	size_t initial_x = screen_rect.pos.x / tiled->tile_size.width;                                 \
-	size_t initial_y = screen_rect.pos.y / tiled->tile_size.height;                                \
-	size_t final_x = ((screen_rect.pos.x + screen_rect.size.width) / tiled->tile_size.width) + 1;  \
-	size_t final_y = ((screen_rect.pos.y + screen_rect.size.height) / tiled->tile_size.height) + 1;
-
-#define BEGIN_LOOP()                                                                               \
-	for (size_t y = initial_y; y < final_y; y++) {                                                 \
-		for (size_t x = initial_x; x < final_x; x++) {                                             \
-			size_t tile = (y * (int)tiled->map_size.width) + x;                                    \
-			if (tiled->map[tile] == -1)                                                            \
-				continue;
-
-#define END_LOOP()                                                                                 \
-	}                                                                                              \
-	}
+#include "../include/memory_alloc.h"
+#include "tiled_csv.h"
+#include "tiled_bin_loader.h"
+#include "tiled_render.h"
 
 // Init a Tiled map
 Tiled *tiled_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path, Size map_size,
@@ -33,62 +18,79 @@ Tiled *tiled_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path,
 	tiled_map->tile_size = tile_size;
 	tiled_map->sprite = sprite;
 
-	// allocate map
-	tiled_map->map = mem_zone_alloc(memory_pool, map_size.width * map_size.height);
-	memset(tiled_map->map, -1, map_size.width * map_size.height);
+	// allocate map (if the size is unknown it grows while reading the file)
+	size_t tile_count = map_size.width * map_size.height;
+	bool infer_size = tile_count == 0;
+	tiled_map->map = infer_size ? NULL : MEM_ALLOC(tile_count * sizeof(tiled_index_t), memory_pool);
 
 	// read file from dfs
-	const char *tok;
 	int fp = dfs_open(map_path);
+	size_t width;
+	size_t read = tiled_csv_read(fp, memory_pool, &tiled_map->map, tile_count, infer_size, &width);
+	dfs_close(fp);
 
-	char *buffer = malloc(dfs_size(fp));
-	int bytes_read;
-	size_t i = 0;
-	while ((bytes_read = dfs_read(buffer, sizeof(char), dfs_size(fp), fp)) > 0 &&
-		   i < map_size.width * map_size.height) {
-		for (tok = strtok(buffer, ","); tok && *tok; tok = strtok(NULL, ",\n\r")) {
-			tiled_map->map[i] = (char)atoi(tok);
-			++i;
-		}
+	if (infer_size) {
+		// shrink the map to the tiles read
+		size_t map_bytes = read * sizeof(tiled_index_t);
+		tiled_map->map = memory_pool ? mem_zone_realloc_last(memory_pool, tiled_map->map, map_bytes)
+									 : realloc(tiled_map->map, map_bytes);
+		tiled_map->map_size = new_size(width, width ? read / width : 0);
+	} else {
+		memset(tiled_map->map + read, TILED_EMPTY_BYTE,
+			   (tile_count - read) * sizeof(tiled_index_t));
 	}
 
-	free(buffer);
-	dfs_close(fp);
+	tiled_row_runs_build(memory_pool, &tiled_map->row_runs, tiled_map->map, tiled_map->map_size);
 
 	return tiled_map;
 }
 
-void tiled_render(display_context_t disp, Tiled *tiled, Rect screen_rect) {
-	SET_VARS()
+Tiled *tiled_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path) {
+	TiledBinHeader header;
+	int fp = tiled_bin_open(map_path, &header, 0);
 
-	BEGIN_LOOP()
+	Tiled *tiled_map = MEM_ALLOC(sizeof(Tiled), memory_pool);
+	tiled_map->map_size = new_size(header.width, header.height);
+	tiled_map->tile_size = new_size(header.tile_width, header.tile_height);
+	tiled_map->sprite = sprite;
 
-	graphics_draw_sprite_trans_stride(disp, x * tiled->tile_size.width, y * tiled->tile_size.height,
-									  tiled->sprite, tiled->map[tile]);
+	// only the first layer is used
+	size_t tile_count = header.width * header.height;
+	tiled_map->map = MEM_ALLOC(tile_count * sizeof(tiled_index_t), memory_pool);
+	tiled_bin_read_tiles(fp, tiled_map->map, tile_count);
+	dfs_close(fp);
 
-	END_LOOP()
-}
+	tiled_row_runs_build(memory_pool, &tiled_map->row_runs, tiled_map->map, tiled_map->map_size);
 
-void tiled_render_rdp(Tiled *tiled, Rect screen_rect) {
-	rdp_sync(SYNC_PIPE);
-	SET_VARS()
+	return tiled_map;
+}
 
-	int last_tile = -1;
+void tiled_build_row_runs(MemZone *memory_pool, Tiled *tiled) {
+	if (!memory_pool)
+		tiled_row_runs_free(&tiled->row_runs);
 
-	BEGIN_LOOP()
+	tiled_row_runs_build(memory_pool, &tiled->row_runs, tiled->map, tiled->map_size);
+}
 
-	if (last_tile != tiled->map[tile]) {
-		last_tile = tiled->map[tile];
-		rdp_load_texture_stride(0, 0, MIRROR_DISABLED, tiled->sprite, tiled->map[tile]);
-	}
+void tiled_render(display_context_t disp, Tiled *tiled, Rect screen_rect) {
+	TiledView view = tiled_view(tiled->map_size, tiled->tile_size, screen_rect,
+								new_position_same(1));
+	tiled_render_view(disp, tiled->map, tiled->map_size, tiled->tile_size, &tiled->row_runs,
+					  tiled->sprite, &view);
+}
 
-	rdp_draw_textured_rectangle(0, x * tiled->tile_size.width, y * tiled->tile_size.height,
-								x * tiled->tile_size.width + tiled->tile_size.width,
-								y * tiled->tile_size.height + tiled->tile_size.height,
-								MIRROR_DISABLED);
+void tiled_render_rdp(Tiled *tiled, Rect screen_rect) {
+	rdp_sync(SYNC_PIPE);
 
-	END_LOOP()
+	TiledView view = tiled_view(tiled->map_size, tiled->tile_size, screen_rect,
+								new_position_same(1));
+	int last_tile = -1;
+	tiled_render_view_rdp(tiled->map, tiled->map_size, tiled->tile_size, &tiled->row_runs,
+						  tiled->sprite, &view, &last_tile);
 }
 
 void tiled_destroy(Tiled *tiled) {
+	tiled_row_runs_free(&tiled->row_runs);
+	free(tiled->map);
+	free(tiled);
 }
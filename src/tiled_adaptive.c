@@ -0,0 +1,132 @@
+#include "../include/tiled_adaptive.h"
+
+#include <string.h>
+#include "../include/memory_alloc.h"
+#include "tiled_render.h"
+
+/*
+ * Counts the tiles of each chunk and the texture loads of drawing it row by row. Each row of a
+ * chunk starts with no texture loaded, so it may count one more load than drawing the screen row.
+ */
+static void tiled_adaptive_count(TiledAdaptive *adaptive) {
+	Tiled *tiled = adaptive->tiled;
+	TiledCached *cached = adaptive->cached;
+	int map_width = tiled->map_size.width;
+	int map_height = tiled->map_size.height;
+
+	size_t chunk_count = cached->chunks_per_row * cached->chunks_per_column;
+	memset(adaptive->chunks, 0, sizeof(TiledAdaptiveChunk) * chunk_count);
+
+	for (int y = 0; y < map_height; ++y) {
+		TiledAdaptiveChunk *row_chunks =
+			&adaptive->chunks[(y / TILED_CACHED_CHUNK_SIZE) * cached->chunks_per_row];
+		const tiled_index_t *row = &tiled->map[y * map_width];
+
+		int last_tile = -1;
+		for (int x = 0; x < map_width; ++x) {
+			if (x % TILED_CACHED_CHUNK_SIZE == 0)
+				last_tile = -1;
+			if (row[x] == TILED_EMPTY_TILE)
+				continue;
+
+			TiledAdaptiveChunk *chunk = &row_chunks[x / TILED_CACHED_CHUNK_SIZE];
+			++chunk->tiles;
+			if (row[x] != last_tile) {
+				last_tile = row[x];
+				++chunk->switches;
+			}
+		}
+	}
+}
+
+TiledAdaptive *tiled_adaptive_init(MemZone *memory_pool, Tiled *tiled) {
+	TiledAdaptive *adaptive = MEM_ALLOC(sizeof(TiledAdaptive), memory_pool);
+	adaptive->tiled = tiled;
+	adaptive->cached = tiled_cached_init_map(memory_pool, tiled->sprite, tiled->map,
+											 tiled->map_size, tiled->tile_size);
+	adaptive->frame = 0;
+	adaptive->rows_loads = 0;
+	adaptive->grouped_loads = 0;
+
+	size_t chunk_count = adaptive->cached->chunks_per_row * adaptive->cached->chunks_per_column;
+	adaptive->chunks = MEM_ALLOC(sizeof(TiledAdaptiveChunk) * chunk_count, memory_pool);
+	tiled_adaptive_count(adaptive);
+
+	// one entry for each tile up to the highest one used
+	size_t tile_count = adaptive->cached->tile_count;
+	adaptive->tile_seen = MEM_ALLOC(sizeof(uint32_t) * tile_count, memory_pool);
+	memset(adaptive->tile_seen, 0, sizeof(uint32_t) * tile_count);
+
+	return adaptive;
+}
+
+TiledAdaptiveStrategy tiled_adaptive_render_rdp(TiledAdaptive *adaptive, Rect screen_rect) {
+	++adaptive->frame;
+
+	TiledCached *cached = adaptive->cached;
+	TiledView view = tiled_view(cached->map_size, cached->tile_size, screen_rect,
+								new_position_same(1));
+
+	// loads of each strategy for the chunks on the screen, and the tiles grouping goes through
+	// outside of the screen
+	uint32_t rows_loads = 0;
+	uint32_t grouped_loads = 0;
+	uint32_t grouped_skips = 0;
+	if (view.initial_x < view.final_x && view.initial_y < view.final_y) {
+		int chunk_x0 = view.initial_x / TILED_CACHED_CHUNK_SIZE;
+		int chunk_y0 = view.initial_y / TILED_CACHED_CHUNK_SIZE;
+		int chunk_x1 = (view.final_x - 1) / TILED_CACHED_CHUNK_SIZE + 1;
+		int chunk_y1 = (view.final_y - 1) / TILED_CACHED_CHUNK_SIZE + 1;
+		for (int y = chunk_y0; y < chunk_y1; ++y) {
+			for (int x = chunk_x0; x < chunk_x1; ++x) {
+				size_t c = y * cached->chunks_per_row + x;
+
+				// part of the chunk on the screen (tiles are assumed to be spread evenly)
+				int start_x = x * TILED_CACHED_CHUNK_SIZE;
+				int start_y = y * TILED_CACHED_CHUNK_SIZE;
+				int x0 = start_x > view.initial_x ? start_x : view.initial_x;
+				int y0 = start_y > view.initial_y ? start_y : view.initial_y;
+				int end_x = start_x + TILED_CACHED_CHUNK_SIZE < cached->map_size.width
+								? start_x + TILED_CACHED_CHUNK_SIZE
+								: cached->map_size.width;
+				int end_y = start_y + TILED_CACHED_CHUNK_SIZE < cached->map_size.height
+								? start_y + TILED_CACHED_CHUNK_SIZE
+								: cached->map_size.height;
+				int x1 = end_x < view.final_x ? end_x : view.final_x;
+				int y1 = end_y < view.final_y ? end_y : view.final_y;
+				int chunk_area = (end_x - start_x) * (end_y - start_y);
+				int inside_area = (x1 - x0) * (y1 - y0);
+				int outside_area = chunk_area - inside_area;
+				rows_loads += adaptive->chunks[c].switches * inside_area / chunk_area;
+				grouped_skips += adaptive->chunks[c].tiles * outside_area / chunk_area;
+
+				// tiles already found on another chunk are loaded only once
+				TiledCachedChunk *chunk = &cached->chunks[c];
+				for (size_t i = 0; i < chunk->tile_count; ++i) {
+					if (adaptive->tile_seen[chunk->tiles[i].tile] != adaptive->frame) {
+						adaptive->tile_seen[chunk->tiles[i].tile] = adaptive->frame;
+						++grouped_loads;
+					}
+				}
+			}
+		}
+	}
+	adaptive->rows_loads = rows_loads;
+	adaptive->grouped_loads = grouped_loads;
+
+	if (grouped_loads * TILED_ADAPTIVE_LOAD_COST + grouped_skips <
+		rows_loads * TILED_ADAPTIVE_LOAD_COST) {
+		tiled_cached_render(cached, screen_rect);
+		return TILED_ADAPTIVE_GROUPED;
+	}
+
+	tiled_render_rdp(adaptive->tiled, screen_rect);
+	return TILED_ADAPTIVE_ROWS;
+}
+
+void tiled_adaptive_destroy(TiledAdaptive *adaptive) {
+	free(adaptive->tile_seen);
+	free(adaptive->chunks);
+	tiled_cached_destroy(adaptive->cached);
+	free(adaptive);
+}
@@ -0,0 +1,207 @@
+#include "../include/tiled_baked.h"
+
+#include "../include/memory_alloc.h"
+#include "tiled_blit.h"
+#include "tiled_render.h"
+
+#define IS_POWER_OF_TWO(VALUE) ((VALUE) > 0 && ((VALUE) & ((VALUE)-1)) == 0)
+
+static TiledBakedChunk *tiled_baked_find(TiledBaked *baked, int chunk_x, int chunk_y) {
+	for (size_t i = 0; i < baked->chunk_count; ++i) {
+		if (baked->chunks[i].chunk_x == chunk_x && baked->chunks[i].chunk_y == chunk_y)
+			return &baked->chunks[i];
+	}
+	return NULL;
+}
+
+/*
+ * Bakes a chunk into an empty slot, or into the least recently used one. Chunks drawn on this
+ * frame are never replaced, since the RDP may not have loaded their texture yet.
+ * Returns NULL if all slots were drawn on this frame.
+ */
+static TiledBakedChunk *tiled_baked_bake(TiledBaked *baked, int chunk_x, int chunk_y) {
+	TiledBakedChunk *slot = NULL;
+	for (size_t i = 0; i < baked->chunk_count; ++i) {
+		TiledBakedChunk *chunk = &baked->chunks[i];
+		if (chunk->chunk_x < 0) {
+			slot = chunk;
+			break;
+		}
+		if (chunk->last_used != baked->frame && (!slot || chunk->last_used < slot->last_used))
+			slot = chunk;
+	}
+	if (!slot)
+		return NULL;
+
+	Tiled *tiled = baked->tiled;
+	int tile_width = tiled->tile_size.width;
+	int tile_height = tiled->tile_size.height;
+
+	TiledView view;
+	view.initial_x = chunk_x * baked->chunk_size.width;
+	view.initial_y = chunk_y * baked->chunk_size.height;
+	view.final_x = view.initial_x + baked->chunk_size.width;
+	view.final_y = view.initial_y + baked->chunk_size.height;
+	if (view.final_x > tiled->map_size.width)
+		view.final_x = tiled->map_size.width;
+	if (view.final_y > tiled->map_size.height)
+		view.final_y = tiled->map_size.height;
+	view.offset_x = -view.initial_x * tile_width;
+	view.offset_y = -view.initial_y * tile_height;
+
+	sprite_t *sprite = slot->sprite;
+	tiled_blit_clear(sprite, 0, 0, sprite->width, sprite->height);
+
+	slot->empty = true;
+	TILED_BEGIN_LOOP(tiled->map, tiled->map_size, &tiled->row_runs, &view)
+
+	tiled_blit_tile(sprite, tiled->sprite, tile, x * tile_width + view.offset_x,
+					y * tile_height + view.offset_y);
+	slot->empty = false;
+
+	TILED_END_LOOP()
+
+	slot->chunk_x = chunk_x;
+	slot->chunk_y = chunk_y;
+	return slot;
+}
+
+TiledBaked *tiled_baked_init(MemZone *memory_pool, Tiled *tiled, Size chunk_size,
+							 size_t chunk_count, size_t bakes_per_frame) {
+	int bitdepth = tiled->sprite->bitdepth;
+	int width = chunk_size.width * tiled->tile_size.width;
+	int height = chunk_size.height * tiled->tile_size.height;
+	if (!TILED_BLIT_SUPPORTED(tiled->sprite))
+		abort();  // Only 16 and 32 bits sprites can be baked.
+	if (!IS_POWER_OF_TWO(width) || !IS_POWER_OF_TWO(height) ||
+		width * bitdepth > TILED_BAKED_TMEM_SIZE)
+		abort();  // Textures have to be a power of two, and at least one row has to fit TMEM.
+
+	TiledBaked *baked = MEM_ALLOC(sizeof(TiledBaked), memory_pool);
+	baked->tiled = tiled;
+	baked->chunk_size = chunk_size;
+	baked->chunk_pixels = new_size(width, height);
+	baked->chunks_per_row = (tiled->map_size.width + chunk_size.width - 1) / chunk_size.width;
+	baked->chunks_per_column =
+		(tiled->map_size.height + chunk_size.height - 1) / chunk_size.height;
+	baked->bakes_per_frame = bakes_per_frame;
+	baked->frame = 0;
+
+	// as many rows as fit TMEM (both are powers of two, so the slices split the chunk evenly)
+	baked->slice_height = TILED_BAKED_TMEM_SIZE / (width * bitdepth);
+	if (baked->slice_height > height)
+		baked->slice_height = height;
+
+	// all chunks are allocated once, and replaced while the screen moves
+	size_t sprite_size = (sizeof(sprite_t) + width * height * bitdepth + 15) & ~(size_t)15;
+	baked->chunk_count = chunk_count;
+	baked->chunks = MEM_ALLOC(sizeof(TiledBakedChunk) * chunk_count, memory_pool);
+	char *sprites = MEM_ALLOC(sprite_size * chunk_count, memory_pool);
+	for (size_t i = 0; i < chunk_count; ++i) {
+		sprite_t *sprite = (sprite_t *)(sprites + i * sprite_size);
+		sprite->width = width;
+		sprite->height = height;
+		sprite->bitdepth = bitdepth;
+		sprite->format = tiled->sprite->format;
+		sprite->hslices = 1;
+		sprite->vslices = height / baked->slice_height;
+
+		baked->chunks[i].sprite = sprite;
+		baked->chunks[i].chunk_x = -1;
+		baked->chunks[i].chunk_y = -1;
+		baked->chunks[i].last_used = 0;
+		baked->chunks[i].empty = true;
+	}
+
+	return baked;
+}
+
+void tiled_baked_invalidate(TiledBaked *baked) {
+	for (size_t i = 0; i < baked->chunk_count; ++i) {
+		baked->chunks[i].chunk_x = -1;
+		baked->chunks[i].chunk_y = -1;
+	}
+}
+
+void tiled_baked_render_rdp(TiledBaked *baked, Rect screen_rect) {
+	++baked->frame;
+
+	Tiled *tiled = baked->tiled;
+	int chunk_width = baked->chunk_pixels.width;
+	int chunk_height = baked->chunk_pixels.height;
+	int slice_height = baked->slice_height;
+
+	// chunks that touch the screen, clamped to the map
+	int left = screen_rect.pos.x;
+	int top = screen_rect.pos.y;
+	int right = screen_rect.pos.x + screen_rect.size.width;
+	int bottom = screen_rect.pos.y + screen_rect.size.height;
+	int x0 = left > 0 ? left / chunk_width : 0;
+	int y0 = top > 0 ? top / chunk_height : 0;
+	int x1 = right > 0 ? right / chunk_width + 1 : 0;
+	int y1 = bottom > 0 ? bottom / chunk_height + 1 : 0;
+	if (x1 > (int)baked->chunks_per_row)
+		x1 = baked->chunks_per_row;
+	if (y1 > (int)baked->chunks_per_column)
+		y1 = baked->chunks_per_column;
+
+	TiledView screen_view = tiled_view(tiled->map_size, tiled->tile_size, screen_rect,
+									   new_position_same(1));
+
+	rdp_sync(SYNC_PIPE);
+
+	size_t bakes = 0;
+	int last_tile = -1;
+	for (int chunk_y = y0; chunk_y < y1; ++chunk_y) {
+		for (int chunk_x = x0; chunk_x < x1; ++chunk_x) {
+			TiledBakedChunk *chunk = tiled_baked_find(baked, chunk_x, chunk_y);
+			if (!chunk && bakes < baked->bakes_per_frame) {
+				chunk = tiled_baked_bake(baked, chunk_x, chunk_y);
+				++bakes;
+			}
+
+			if (!chunk) {
+				// not baked yet, so the tiles of the chunk on the screen are drawn one by one
+				TiledView view = screen_view;
+				int start_x = chunk_x * baked->chunk_size.width;
+				int start_y = chunk_y * baked->chunk_size.height;
+				if (view.initial_x < start_x)
+					view.initial_x = start_x;
+				if (view.initial_y < start_y)
+					view.initial_y = start_y;
+				if (view.final_x > start_x + baked->chunk_size.width)
+					view.final_x = start_x + baked->chunk_size.width;
+				if (view.final_y > start_y + baked->chunk_size.height)
+					view.final_y = start_y + baked->chunk_size.height;
+
+				tiled_render_view_rdp(tiled->map, tiled->map_size, tiled->tile_size,
+									  &tiled->row_runs, tiled->sprite, &view, &last_tile);
+				continue;
+			}
+
+			chunk->last_used = baked->frame;
+			if (chunk->empty)
+				continue;
+
+			// one load and one rectangle for each slice on the screen
+			int draw_x = chunk_x * chunk_width;
+			int draw_y = chunk_y * chunk_height;
+			for (int slice = 0; slice < chunk->sprite->vslices; ++slice) {
+				int slice_y = draw_y + slice * slice_height;
+				if (slice_y + slice_height <= top || slice_y >= bottom)
+					continue;
+
+				rdp_load_texture_stride(0, 0, MIRROR_DISABLED, chunk->sprite, slice);
+				rdp_draw_textured_rectangle(0, draw_x, slice_y, draw_x + chunk_width,
+											slice_y + slice_height, MIRROR_DISABLED);
+			}
+			last_tile = -1;
+		}
+	}
+}
+
+void tiled_baked_destroy(TiledBaked *baked) {
+	free(baked->chunks[0].sprite);
+	free(baked->chunks);
+	free(baked);
+}
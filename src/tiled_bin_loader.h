@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <libdragon.h>
+#include "../include/tiled_bin.h"
+#include "../include/tiled_tile.h"
+
+/*
+ * Opens the binary map 'map_path' and reads its header into 'header'. 'flags' has to match the
+ * flags of the file (eg.: TILED_BIN_FLAG_CHUNKED if the loader expects chunks).
+ *
+ * Returns the file handle positioned at the tiles of the first layer.
+ */
+static inline int tiled_bin_open(const char *map_path, TiledBinHeader *header, uint16_t flags) {
+	int fp = dfs_open(map_path);
+	if (fp < 0)
+		abort();  // Put your error handling here.
+
+	if (dfs_read(header, 1, sizeof(TiledBinHeader), fp) != sizeof(TiledBinHeader) ||
+		header->magic != TILED_BIN_MAGIC || header->version != TILED_BIN_VERSION ||
+		header->index_bytes != sizeof(tiled_index_t))
+		abort();  // Not a binary map, from another format version or using another index size.
+
+	if (header->flags != flags)
+		abort();  // Chunked maps can only be loaded by 'tiled_stream_init' (and vice-versa).
+
+	return fp;
+}
+
+/*
+ * Reads 'tile_count' tiles from 'fp' directly into 'map'. Tiles missing from the file are empty.
+ */
+static inline void tiled_bin_read_tiles(int fp, tiled_index_t *map, size_t tile_count) {
+	size_t map_bytes = tile_count * sizeof(tiled_index_t);
+	int read = dfs_read(map, 1, map_bytes, fp);
+	if (read < 0)
+		read = 0;
+
+	memset((char *)map + read, TILED_EMPTY_BYTE, map_bytes - read);
+}
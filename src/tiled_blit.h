@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string.h>
+#include <libdragon.h>
+
+// Pixels of 'sprite', as bytes.
+#define SPRITE_PIXELS(SPRITE) ((uint8_t *)(SPRITE)->data)
+// If the sprite can be drawn by 'tiled_blit_tile' (16 or 32 bits).
+#define TILED_BLIT_SUPPORTED(SPRITE) ((SPRITE)->bitdepth == 2 || (SPRITE)->bitdepth == 4)
+
+/*
+ * Clears the area of 'dst' from (x, y) with size (width, height) to transparent. The area has to
+ * be inside 'dst'.
+ */
+static inline void tiled_blit_clear(sprite_t *dst, int x, int y, int width, int height) {
+	int pitch = dst->width * dst->bitdepth;
+	uint8_t *row = SPRITE_PIXELS(dst) + y * pitch + x * dst->bitdepth;
+	for (int i = 0; i < height; ++i, row += pitch)
+		memset(row, 0, width * dst->bitdepth);
+}
+
+/*
+ * Draws the slice 'offset' of 'tileset' on 'dst' at (x, y), clipped to 'dst', skipping transparent
+ * pixels (same as 'graphics_draw_sprite_trans_stride', but drawing to a sprite instead of the
+ * display). Both sprites need to have the same bit depth (see 'TILED_BLIT_SUPPORTED').
+ */
+static inline void tiled_blit_tile(sprite_t *dst, sprite_t *tileset, int offset, int x, int y) {
+	int tile_width = tileset->width / tileset->hslices;
+	int tile_height = tileset->height / tileset->vslices;
+	int source_x = (offset % tileset->hslices) * tile_width;
+	int source_y = (offset / tileset->hslices) * tile_height;
+
+	// clip to the destination
+	int x0 = x < 0 ? -x : 0;
+	int y0 = y < 0 ? -y : 0;
+	int x1 = x + tile_width > dst->width ? dst->width - x : tile_width;
+	int y1 = y + tile_height > dst->height ? dst->height - y : tile_height;
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	if (tileset->bitdepth == 2) {
+		for (int j = y0; j < y1; ++j) {
+			uint16_t *src = (uint16_t *)SPRITE_PIXELS(tileset) +
+							(source_y + j) * tileset->width + source_x;
+			uint16_t *out = (uint16_t *)SPRITE_PIXELS(dst) + (y + j) * dst->width + x;
+			for (int i = x0; i < x1; ++i) {
+				if (src[i] & 1)  // alpha bit
+					out[i] = src[i];
+			}
+		}
+	} else {
+		for (int j = y0; j < y1; ++j) {
+			uint32_t *src = (uint32_t *)SPRITE_PIXELS(tileset) +
+							(source_y + j) * tileset->width + source_x;
+			uint32_t *out = (uint32_t *)SPRITE_PIXELS(dst) + (y + j) * dst->width + x;
+			for (int i = x0; i < x1; ++i) {
+				if (src[i] & 0xFF)  // alpha channel
+					out[i] = src[i];
+			}
+		}
+	}
+}
+
+/*
+ * Moves the pixels of 'sprite' by (-dx, -dy), as if the camera moved by (dx, dy). The area that
+ * is exposed keeps its old pixels and has to be redrawn.
+ */
+static inline void tiled_blit_scroll(sprite_t *sprite, int dx, int dy) {
+	int bpp = sprite->bitdepth;
+	int pitch = sprite->width * bpp;
+	int width = sprite->width - (dx < 0 ? -dx : dx);
+	int height = sprite->height - (dy < 0 ? -dy : dy);
+	if (width <= 0 || height <= 0)
+		return;
+
+	int src_x = dx > 0 ? dx : 0;
+	int dst_x = dx < 0 ? -dx : 0;
+	uint8_t *pixels = SPRITE_PIXELS(sprite);
+	if (dy > 0) {
+		for (int y = 0; y < height; ++y)
+			memmove(pixels + y * pitch + dst_x * bpp, pixels + (y + dy) * pitch + src_x * bpp,
+					width * bpp);
+	} else {
+		for (int y = height - 1; y >= 0; --y)
+			memmove(pixels + (y - dy) * pitch + dst_x * bpp, pixels + y * pitch + src_x * bpp,
+					width * bpp);
+	}
+}
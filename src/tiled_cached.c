@@ -1,6 +1,162 @@
 #include "../include/tiled_cached.h"
 
 #include <string.h>
+#include "../include/memory_alloc.h"
+#include "tiled_csv.h"
+#include "tiled_bin_loader.h"
+#include "tiled_render.h"
+
+/*
+ * Allocates memory only used while loading. It goes on the top of the pool, if any, which does not
+ * add chunks to a chained pool, so the current chunk needs room for it.
+ */
+static void *tiled_cached_alloc_temp(MemZone *memory_pool, size_t size) {
+	void *data = memory_pool ? mem_zone_alloc_top(memory_pool, size) : malloc(size);
+	if (!data && size > 0)
+		abort();  // Put your error handling here.
+	return data;
+}
+
+// Frees memory from 'tiled_cached_alloc_temp'. On a pool it is freed by rewinding the top instead.
+static void tiled_cached_free_temp(MemZone *memory_pool, void *data) {
+	if (!memory_pool)
+		free(data);
+}
+
+// Allocates the temporary map used while loading.
+static tiled_index_t *tiled_cached_alloc_map(MemZone *memory_pool, MemZoneMarker *marker,
+											 size_t tile_count) {
+	if (memory_pool)
+		*marker = mem_zone_mark_top(memory_pool);
+	return tiled_cached_alloc_temp(memory_pool, tile_count * sizeof(tiled_index_t));
+}
+
+static void tiled_cached_free_map(MemZone *memory_pool, MemZoneMarker marker,
+								  tiled_index_t *map) {
+	if (memory_pool)
+		mem_zone_rewind_top_to(memory_pool, marker);
+	else
+		free(map);
+}
+
+/*
+ * Caches the positions of each tile type of 'map', split by chunk. Each chunk has its tiles sorted
+ * by tile, so rendering can merge the visible chunks.
+ *
+ * Positions are sorted by tile and then (keeping that order) by chunk, using counting sorts, so
+ * the time does not depend on the amount of tile types. Chunks, tiles and positions are a single
+ * allocation that starts at 'chunks'.
+ */
+static void tiled_cached_fill(MemZone *memory_pool, TiledCached *tiled_map,
+							  const tiled_index_t *map) {
+	int map_width = tiled_map->map_size.width;
+	int map_height = tiled_map->map_size.height;
+	size_t map_tiles = map_width * map_height;
+
+	tiled_map->chunks_per_row = (map_width + TILED_CACHED_CHUNK_SIZE - 1) / TILED_CACHED_CHUNK_SIZE;
+	tiled_map->chunks_per_column =
+		(map_height + TILED_CACHED_CHUNK_SIZE - 1) / TILED_CACHED_CHUNK_SIZE;
+	size_t chunk_count = tiled_map->chunks_per_row * tiled_map->chunks_per_column;
+
+	// only tiles up to the highest one used are counted
+	size_t tile_count = 0;
+	for (size_t i = 0; i < map_tiles; ++i) {
+		if (map[i] != TILED_EMPTY_TILE && map[i] >= tile_count)
+			tile_count = map[i] + 1;
+	}
+	tiled_map->tile_count = tile_count;
+
+#define CHUNK_OF(INDEX)                                                                            \
+	(((INDEX) / map_width / TILED_CACHED_CHUNK_SIZE) * tiled_map->chunks_per_row +                 \
+	 ((INDEX) % map_width) / TILED_CACHED_CHUNK_SIZE)
+
+	MemZoneMarker marker;
+	if (memory_pool)
+		marker = mem_zone_mark_top(memory_pool);
+	// first position of each tile (and of each chunk) once sorted
+	uint32_t *tile_first =
+		tiled_cached_alloc_temp(memory_pool, sizeof(uint32_t) * (tile_count + 1));
+	uint32_t *chunk_first =
+		tiled_cached_alloc_temp(memory_pool, sizeof(uint32_t) * (chunk_count + 1));
+	// amount of tile types of each chunk, and the last one found while sorting
+	uint32_t *chunk_tiles = tiled_cached_alloc_temp(memory_pool, sizeof(uint32_t) * chunk_count);
+	int32_t *chunk_last = tiled_cached_alloc_temp(memory_pool, sizeof(int32_t) * chunk_count);
+
+	memset(tile_first, 0, sizeof(uint32_t) * (tile_count + 1));
+	memset(chunk_first, 0, sizeof(uint32_t) * (chunk_count + 1));
+	for (size_t i = 0; i < map_tiles; ++i) {
+		if (map[i] != TILED_EMPTY_TILE) {
+			++tile_first[map[i] + 1];
+			++chunk_first[CHUNK_OF(i) + 1];
+		}
+	}
+	for (size_t tile = 0; tile < tile_count; ++tile)
+		tile_first[tile + 1] += tile_first[tile];
+	for (size_t c = 0; c < chunk_count; ++c)
+		chunk_first[c + 1] += chunk_first[c];
+	size_t position_count = tile_first[tile_count];
+
+	// map indexes sorted by tile
+	uint32_t *by_tile = tiled_cached_alloc_temp(memory_pool, sizeof(uint32_t) * position_count);
+	for (size_t i = 0; i < map_tiles; ++i) {
+		if (map[i] != TILED_EMPTY_TILE)
+			by_tile[tile_first[map[i]]++] = i;
+	}
+
+	// tiles come in order, so each chunk has a new tile type whenever the tile changes
+	size_t group_count = 0;
+	memset(chunk_tiles, 0, sizeof(uint32_t) * chunk_count);
+	memset(chunk_last, 0xFF, sizeof(int32_t) * chunk_count);
+	for (size_t i = 0; i < position_count; ++i) {
+		size_t c = CHUNK_OF(by_tile[i]);
+		if (chunk_last[c] != map[by_tile[i]]) {
+			chunk_last[c] = map[by_tile[i]];
+			++chunk_tiles[c];
+			++group_count;
+		}
+	}
+
+	tiled_map->chunks = MEM_ALLOC(sizeof(TiledCachedChunk) * chunk_count +
+									  sizeof(TiledCachedTile) * group_count +
+									  sizeof(PositionInt) * position_count,
+								  memory_pool);
+	TiledCachedTile *groups = (TiledCachedTile *)(tiled_map->chunks + chunk_count);
+	PositionInt *positions = (PositionInt *)(groups + group_count);
+	for (size_t c = 0; c < chunk_count; ++c) {
+		tiled_map->chunks[c].tiles = groups;
+		tiled_map->chunks[c].tile_count = 0;
+		groups += chunk_tiles[c];
+	}
+
+	// stable sort by chunk, so the tiles of each chunk stay sorted
+	memset(chunk_last, 0xFF, sizeof(int32_t) * chunk_count);
+	for (size_t i = 0; i < position_count; ++i) {
+		size_t index = by_tile[i];
+		size_t c = CHUNK_OF(index);
+		TiledCachedChunk *chunk = &tiled_map->chunks[c];
+		PositionInt *position = &positions[chunk_first[c]++];
+		if (chunk_last[c] != map[index]) {
+			chunk_last[c] = map[index];
+			chunk->tiles[chunk->tile_count].tile = map[index];
+			chunk->tiles[chunk->tile_count].count = 0;
+			chunk->tiles[chunk->tile_count].position = position;
+			++chunk->tile_count;
+		}
+
+		*position = new_position_int(index % map_width, index / map_width);
+		++chunk->tiles[chunk->tile_count - 1].count;
+	}
+
+#undef CHUNK_OF
+
+	tiled_cached_free_temp(memory_pool, by_tile);
+	tiled_cached_free_temp(memory_pool, chunk_last);
+	tiled_cached_free_temp(memory_pool, chunk_tiles);
+	tiled_cached_free_temp(memory_pool, chunk_first);
+	tiled_cached_free_temp(memory_pool, tile_first);
+	if (memory_pool)
+		mem_zone_rewind_top_to(memory_pool, marker);
+}
 
 TiledCached *tiled_cached_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path,
 							   Size map_size, Size tile_size) {
@@ -13,83 +169,139 @@ TiledCached *tiled_cached_init(MemZone *memory_pool, sprite_t *sprite, const cha
 	tiled_map->tile_size = tile_size;
 	tiled_map->sprite = sprite;
 
-	// allocate map
-	char *map = malloc(map_size.width * map_size.height);
-	memset(map, -1, map_size.width * map_size.height);
+	// the map is only used while loading
+	MemZoneMarker marker;
+	size_t tile_count = map_size.width * map_size.height;
+	tiled_index_t *map = tiled_cached_alloc_map(memory_pool, &marker, tile_count);
 
 	// read file from dfs
-	const char *tok;
 	int fp = dfs_open(map_path);
+	size_t width;
+	size_t read = tiled_csv_read(fp, NULL, &map, tile_count, false, &width);
+	dfs_close(fp);
 
-	char *buffer = malloc(dfs_size(fp));
-	int bytes_read;
-	size_t i = 0;
-	while ((bytes_read = dfs_read(buffer, sizeof(char), dfs_size(fp), fp)) > 0 &&
-		   i < map_size.width * map_size.height) {
-		for (tok = strtok(buffer, ","); tok && *tok; tok = strtok(NULL, ",\n\r")) {
-			map[i] = (char)atoi(tok);
-			++i;
-		}
-	}
+	memset(map + read, TILED_EMPTY_BYTE, (tile_count - read) * sizeof(tiled_index_t));
+
+	tiled_cached_fill(memory_pool, tiled_map, map);
 
-	free(buffer);
+	tiled_cached_free_map(memory_pool, marker, map);
+
+	return tiled_map;
+}
+
+TiledCached *tiled_cached_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path) {
+	TiledBinHeader header;
+	int fp = tiled_bin_open(map_path, &header, 0);
+
+	TiledCached *tiled_map = NULL;
+	if (memory_pool)
+		tiled_map = mem_zone_alloc(memory_pool, sizeof(TiledCached));
+	else
+		tiled_map = malloc(sizeof(TiledCached));
+	tiled_map->map_size = new_size(header.width, header.height);
+	tiled_map->tile_size = new_size(header.tile_width, header.tile_height);
+	tiled_map->sprite = sprite;
+
+	// only the first layer is used
+	MemZoneMarker marker;
+	size_t tile_count = header.width * header.height;
+	tiled_index_t *map = tiled_cached_alloc_map(memory_pool, &marker, tile_count);
+	tiled_bin_read_tiles(fp, map, tile_count);
 	dfs_close(fp);
 
-	// naive lookup
-	for (size_t i = 0; i < 255; ++i) {
-		size_t counter = 0;
-		for (size_t y = 0; y < map_size.height; y++) {
-			for (size_t x = 0; x < map_size.width; x++) {
-				size_t tile = (y * (int)map_size.width) + x;
-				if (map[tile] == i)
-					++counter;
-			}
-		}
-		tiled_map->tiles[i].count = counter;
-		if (counter > 0) {
-			tiled_map->tiles[i].position = malloc(sizeof(PositionInt) * counter);
-			memset(tiled_map->tiles[i].position, 0, sizeof(PositionInt) * counter);
-
-			tiled_map->tiles[i].position[0].x = 0;
-			size_t curr = 0;
-			for (int y = 0; y < map_size.height; y++) {
-				for (int x = 0; x < map_size.width; x++) {
-					size_t tile = (y * (int)map_size.width) + x;
-					if (map[tile] == i) {
-						tiled_map->tiles[i].position[curr].x = x;
-						tiled_map->tiles[i].position[curr].y = y;
-						++curr;
-					}
-				}
-			}
-		}
-	}
+	tiled_cached_fill(memory_pool, tiled_map, map);
+
+	tiled_cached_free_map(memory_pool, marker, map);
+
+	return tiled_map;
+}
+
+TiledCached *tiled_cached_init_map(MemZone *memory_pool, sprite_t *sprite,
+									const tiled_index_t *map, Size map_size, Size tile_size) {
+	TiledCached *tiled_map = MEM_ALLOC(sizeof(TiledCached), memory_pool);
+	tiled_map->map_size = map_size;
+	tiled_map->tile_size = tile_size;
+	tiled_map->sprite = sprite;
 
-	free(map);
+	tiled_cached_fill(memory_pool, tiled_map, map);
 
 	return tiled_map;
 }
 
+// Tiles of a visible chunk that were not drawn yet.
+typedef struct {
+	TiledCachedTile *next, *end;
+} TiledCachedCursor;
+
 // Render a Tiled map
 void tiled_cached_render(TiledCached *tiled, Rect screen_rect) {
+	TiledView view = tiled_view(tiled->map_size, tiled->tile_size, screen_rect,
+								new_position_same(1));
+	if (view.initial_x >= view.final_x || view.initial_y >= view.final_y)
+		return;
+
+	int chunk_x0 = view.initial_x / TILED_CACHED_CHUNK_SIZE;
+	int chunk_y0 = view.initial_y / TILED_CACHED_CHUNK_SIZE;
+	int chunk_x1 = (view.final_x - 1) / TILED_CACHED_CHUNK_SIZE + 1;
+	int chunk_y1 = (view.final_y - 1) / TILED_CACHED_CHUNK_SIZE + 1;
+
+	TiledCachedCursor cursors[(chunk_x1 - chunk_x0) * (chunk_y1 - chunk_y0)];
+	size_t cursor_count = 0;
+	for (int y = chunk_y0; y < chunk_y1; ++y) {
+		for (int x = chunk_x0; x < chunk_x1; ++x) {
+			TiledCachedChunk *chunk = &tiled->chunks[y * tiled->chunks_per_row + x];
+			if (chunk->tile_count == 0)
+				continue;
+
+			cursors[cursor_count].next = chunk->tiles;
+			cursors[cursor_count].end = chunk->tiles + chunk->tile_count;
+			++cursor_count;
+		}
+	}
+
 	rdp_sync(SYNC_PIPE);
 
-	for (size_t i = 0; i < 255; ++i) {
-		if (tiled->tiles[i].count > 0) {
-			rdp_load_texture_stride(0, 0, MIRROR_DISABLED, tiled->sprite, i);
-			for (size_t j = 0; j < tiled->tiles[i].count; ++j) {
-				rdp_draw_textured_rectangle(
-					0, tiled->tiles[i].position[j].x * tiled->tile_size.width,
-					tiled->tiles[i].position[j].y * tiled->tile_size.height,
-					tiled->tiles[i].position[j].x * tiled->tile_size.width + tiled->tile_size.width,
-					tiled->tiles[i].position[j].y * tiled->tile_size.height +
-						tiled->tile_size.height,
-					MIRROR_DISABLED);
+	int tile_width = tiled->tile_size.width;
+	int tile_height = tiled->tile_size.height;
+	while (cursor_count > 0) {
+		// merge the chunks by tile, so each texture is loaded once
+		tiled_index_t tile = cursors[0].next->tile;
+		for (size_t i = 1; i < cursor_count; ++i) {
+			if (cursors[i].next->tile < tile)
+				tile = cursors[i].next->tile;
+		}
+
+		bool loaded = false;
+		for (size_t i = 0; i < cursor_count; ++i) {
+			TiledCachedTile *cached = cursors[i].next;
+			if (cached->tile != tile)
+				continue;
+
+			for (size_t j = 0; j < cached->count; ++j) {
+				PositionInt position = cached->position[j];
+				if (position.x < view.initial_x || position.x >= view.final_x ||
+					position.y < view.initial_y || position.y >= view.final_y)
+					continue;
+
+				if (!loaded) {
+					loaded = true;
+					rdp_load_texture_stride(0, 0, MIRROR_DISABLED, tiled->sprite, tile);
+				}
+
+				int draw_x = position.x * tile_width;
+				int draw_y = position.y * tile_height;
+				rdp_draw_textured_rectangle(0, draw_x, draw_y, draw_x + tile_width,
+											draw_y + tile_height, MIRROR_DISABLED);
 			}
+
+			// chunks that have no tiles left are removed
+			if (++cursors[i].next == cursors[i].end)
+				cursors[i--] = cursors[--cursor_count];
 		}
 	}
 }
 
 void tiled_cached_destroy(TiledCached *tiled) {
+	free(tiled->chunks);
 	free(tiled);
 }
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdbool.h>
+#include <libdragon.h>
+#include "../include/mem_pool.h"
+#include "../include/tiled_tile.h"
+
+// Size of the buffer used to read CSV files. Only this much is read from the file at a time.
+#define FILE_BUFFER_SIZE 512
+
+// Stores 'tile' on 'index', growing the map if needed and allowed. Returns false when it is full.
+static inline bool tiled_csv_store(MemZone *memory_pool, tiled_index_t **map, size_t *capacity,
+								   bool can_grow, size_t index, tiled_index_t tile) {
+	if (index >= *capacity) {
+		if (!can_grow)
+			return false;
+
+		size_t new_capacity = *capacity ? *capacity * 2 : 256;
+		size_t map_bytes = new_capacity * sizeof(tiled_index_t);
+		tiled_index_t *new_map = memory_pool ? mem_zone_realloc_last(memory_pool, *map, map_bytes)
+											 : realloc(*map, map_bytes);
+		if (!new_map)
+			abort();  // Not enough memory for the map (use a chained MemZone or a bigger one).
+
+		*map = new_map;
+		*capacity = new_capacity;
+	}
+
+	(*map)[index] = tile;
+	return true;
+}
+
+/*
+ * Reads the Tiled CSV file 'fp' into '*map', one small piece at a time.
+ *
+ * If 'can_grow' is set, '*map' grows when 'capacity' is not enough, using 'mem_zone_realloc_last'
+ * if 'memory_pool' is set ('*map' has to be its last allocation) or 'realloc' if not, and aborts
+ * if there is no memory left to grow. Otherwise reading stops when the map is full.
+ *
+ * 'capacity' is in tiles. Negative values (-1) are stored as TILED_EMPTY_TILE.
+ *
+ * Returns the amount of tiles read, and sets 'width' to the amount of tiles on the first row.
+ */
+static inline size_t tiled_csv_read(int fp, MemZone *memory_pool, tiled_index_t **map,
+									size_t capacity, bool can_grow, size_t *width) {
+	char buffer[FILE_BUFFER_SIZE];
+	size_t count = 0;
+	int value = 0;
+	bool has_value = false, negative = false;
+
+	*width = 0;
+
+	int bytes_read;
+	while ((bytes_read = dfs_read(buffer, sizeof(char), FILE_BUFFER_SIZE, fp)) > 0) {
+		for (int i = 0; i < bytes_read; ++i) {
+			char c = buffer[i];
+			if (c >= '0' && c <= '9') {
+				value = value * 10 + (c - '0');
+				has_value = true;
+			} else if (c == '-') {
+				negative = true;
+			} else if (c == ',' || c == '\n') {
+				if (has_value) {
+					if (!tiled_csv_store(memory_pool, map, &capacity, can_grow, count,
+										 negative ? TILED_EMPTY_TILE : (tiled_index_t)value))
+						return count;
+					++count;
+				}
+				if (c == '\n' && *width == 0)
+					*width = count;
+
+				value = 0;
+				has_value = false;
+				negative = false;
+			}
+		}
+	}
+
+	// last tile of the file, if there's no line break after it
+	if (has_value &&
+		tiled_csv_store(memory_pool, map, &capacity, can_grow, count,
+						negative ? TILED_EMPTY_TILE : (tiled_index_t)value))
+		++count;
+
+	if (*width == 0)
+		*width = count;
+
+	return count;
+}
\ No newline at end of file
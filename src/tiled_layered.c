@@ -0,0 +1,82 @@
+#include "../include/tiled_layered.h"
+
+#include "../include/memory_alloc.h"
+#include "tiled_bin_loader.h"
+#include "tiled_render.h"
+
+TiledLayered *tiled_layered_init_bin(MemZone *memory_pool, sprite_t *sprite, const char *map_path) {
+	TiledBinHeader header;
+	int fp = tiled_bin_open(map_path, &header, 0);
+
+	TiledLayered *tiled = MEM_ALLOC(sizeof(TiledLayered), memory_pool);
+	tiled->map_size = new_size(header.width, header.height);
+	tiled->tile_size = new_size(header.tile_width, header.tile_height);
+	tiled->sprite = sprite;
+	tiled->layer_count = header.layer_count;
+	tiled->layers = MEM_ALLOC(sizeof(TiledLayer) * header.layer_count, memory_pool);
+
+	// layers are stored one after the other, so they are read at once
+	size_t tile_count = header.width * header.height;
+	tiled_index_t *maps =
+		MEM_ALLOC(tile_count * header.layer_count * sizeof(tiled_index_t), memory_pool);
+	tiled_bin_read_tiles(fp, maps, tile_count * header.layer_count);
+	dfs_close(fp);
+
+	for (size_t i = 0; i < header.layer_count; ++i) {
+		tiled->layers[i].map = maps + i * tile_count;
+		tiled->layers[i].scroll_factor = new_position_same(1);
+		tiled->layers[i].visible = true;
+		tiled_row_runs_build(memory_pool, &tiled->layers[i].row_runs, tiled->layers[i].map,
+							 tiled->map_size);
+	}
+
+	return tiled;
+}
+
+void tiled_layered_build_row_runs(MemZone *memory_pool, TiledLayered *tiled, size_t layer) {
+	if (!memory_pool)
+		tiled_row_runs_free(&tiled->layers[layer].row_runs);
+
+	tiled_row_runs_build(memory_pool, &tiled->layers[layer].row_runs, tiled->layers[layer].map,
+						 tiled->map_size);
+}
+
+void tiled_layered_render_rdp(TiledLayered *tiled, Rect screen_rect, size_t first_layer,
+							  size_t layer_count) {
+	size_t end_layer = first_layer + layer_count;
+	if (end_layer > tiled->layer_count)
+		end_layer = tiled->layer_count;
+
+	rdp_sync(SYNC_PIPE);
+
+	TiledView view;
+	Position view_factor;
+	bool has_view = false;
+	int last_tile = -1;
+	for (size_t i = first_layer; i < end_layer; ++i) {
+		TiledLayer *layer = &tiled->layers[i];
+		if (!layer->visible)
+			continue;
+
+		// layers that scroll the same way have the same tiles on the screen
+		if (!has_view || view_factor.x != layer->scroll_factor.x ||
+			view_factor.y != layer->scroll_factor.y) {
+			view = tiled_view(tiled->map_size, tiled->tile_size, screen_rect,
+							  layer->scroll_factor);
+			view_factor = layer->scroll_factor;
+			has_view = true;
+		}
+
+		tiled_render_view_rdp(layer->map, tiled->map_size, tiled->tile_size, &layer->row_runs,
+							  tiled->sprite, &view, &last_tile);
+	}
+}
+
+void tiled_layered_destroy(TiledLayered *tiled) {
+	for (size_t i = 0; i < tiled->layer_count; ++i)
+		tiled_row_runs_free(&tiled->layers[i].row_runs);
+	if (tiled->layer_count > 0)
+		free(tiled->layers[0].map);
+	free(tiled->layers);
+	free(tiled);
+}
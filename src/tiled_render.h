@@ -0,0 +1,102 @@
+#pragma once
+
+#include <libdragon.h>
+#include "../include/rect.h"
+#include "../include/tiled_tile.h"
+#include "tiled_runs.h"
+
+// Tiles of a map that are inside a view, and where to draw them.
+typedef struct {
+	int initial_x, initial_y, final_x, final_y;
+	// added to the position of every tile when drawing
+	int offset_x, offset_y;
+} TiledView;
+
+/*
+ * Culls the map to 'screen_rect'. The map scrolls 'scroll_factor' times as fast as the screen
+ * (1 is the same speed as the screen, 0 is fixed on the screen).
+ */
+static inline TiledView tiled_view(Size map_size, Size tile_size, Rect screen_rect,
+								   Position scroll_factor) {
+	float view_x = screen_rect.pos.x * scroll_factor.x;
+	float view_y = screen_rect.pos.y * scroll_factor.y;
+
+	TiledView view;
+	view.initial_x = view_x > 0 ? view_x / tile_size.width : 0;
+	view.initial_y = view_y > 0 ? view_y / tile_size.height : 0;
+	view.final_x = ((view_x + screen_rect.size.width) / tile_size.width) + 1;
+	view.final_y = ((view_y + screen_rect.size.height) / tile_size.height) + 1;
+	if (view.final_x > map_size.width)
+		view.final_x = map_size.width;
+	if (view.final_y > map_size.height)
+		view.final_y = map_size.height;
+
+	view.offset_x = screen_rect.pos.x - view_x;
+	view.offset_y = screen_rect.pos.y - view_y;
+	return view;
+}
+
+/*
+ * Loops through the non-empty tiles of 'MAP' inside 'VIEW', jumping from span to span of
+ * 'ROW_RUNS'. Sets 'x', 'y' and 'tile' for the code between this and 'TILED_END_LOOP'.
+ * Tiles inside a span are still checked, in case they were cleared after the spans were built.
+ */
+#define TILED_BEGIN_LOOP(MAP, MAP_SIZE, ROW_RUNS, VIEW)                                            \
+	for (int y = (VIEW)->initial_y; y < (VIEW)->final_y; y++) {                                    \
+		const tiled_index_t *row = &(MAP)[y * (int)(MAP_SIZE).width];                              \
+		const TiledRun *run = tiled_row_runs_find((ROW_RUNS), y, (VIEW)->initial_x);               \
+		const TiledRun *row_end = &(ROW_RUNS)->runs[(ROW_RUNS)->row_first[y + 1]];                 \
+		for (; run < row_end && run->start < (VIEW)->final_x; ++run) {                             \
+			int end_x = run->end < (VIEW)->final_x ? run->end : (VIEW)->final_x;                   \
+			for (int x = run->start > (VIEW)->initial_x ? run->start : (VIEW)->initial_x;          \
+				 x < end_x; x++) {                                                                 \
+				tiled_index_t tile = row[x];                                                       \
+				if (tile == TILED_EMPTY_TILE)                                                      \
+					continue;
+
+#define TILED_END_LOOP()                                                                           \
+	}                                                                                              \
+	}                                                                                              \
+	}
+
+/*
+ * Renders the tiles of 'map' inside 'view' using software rendering.
+ */
+static inline void tiled_render_view(display_context_t disp, const tiled_index_t *map,
+									 Size map_size, Size tile_size, const TiledRowRuns *row_runs,
+									 sprite_t *sprite, TiledView *view) {
+	int tile_width = tile_size.width;
+	int tile_height = tile_size.height;
+
+	TILED_BEGIN_LOOP(map, map_size, row_runs, view)
+
+	graphics_draw_sprite_trans_stride(disp, x * tile_width + view->offset_x,
+									  y * tile_height + view->offset_y, sprite, tile);
+
+	TILED_END_LOOP()
+}
+
+/*
+ * Renders the tiles of 'map' inside 'view' using the RDP. 'last_tile' is the tile currently
+ * loaded on TMEM (-1 if none), so the texture is only loaded when the tile changes.
+ */
+static inline void tiled_render_view_rdp(const tiled_index_t *map, Size map_size, Size tile_size,
+										 const TiledRowRuns *row_runs, sprite_t *sprite,
+										 TiledView *view, int *last_tile) {
+	int tile_width = tile_size.width;
+	int tile_height = tile_size.height;
+
+	TILED_BEGIN_LOOP(map, map_size, row_runs, view)
+
+	if (*last_tile != tile) {
+		*last_tile = tile;
+		rdp_load_texture_stride(0, 0, MIRROR_DISABLED, sprite, tile);
+	}
+
+	int draw_x = x * tile_width + view->offset_x;
+	int draw_y = y * tile_height + view->offset_y;
+	rdp_draw_textured_rectangle(0, draw_x, draw_y, draw_x + tile_width, draw_y + tile_height,
+								MIRROR_DISABLED);
+
+	TILED_END_LOOP()
+}
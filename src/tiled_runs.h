@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdlib.h>
+#include "../include/mem_pool.h"
+#include "../include/memory_alloc.h"
+#include "../include/size.h"
+#include "../include/tiled_tile.h"
+
+/*
+ * Finds the spans of non-empty tiles of every row of 'map'. Uses two passes: one to count the
+ * spans, and one to store them, so it only allocates once.
+ */
+static inline void tiled_row_runs_build(MemZone *memory_pool, TiledRowRuns *row_runs,
+										const tiled_index_t *map, Size map_size) {
+	int width = map_size.width;
+	int height = map_size.height;
+
+	size_t run_count = 0;
+	for (int y = 0; y < height; ++y) {
+		const tiled_index_t *row = &map[y * width];
+		for (int x = 0; x < width; ++x) {
+			if (row[x] != TILED_EMPTY_TILE && (x == 0 || row[x - 1] == TILED_EMPTY_TILE))
+				++run_count;
+		}
+	}
+
+	row_runs->runs = MEM_ALLOC(sizeof(TiledRun) * run_count, memory_pool);
+	row_runs->row_first = MEM_ALLOC(sizeof(uint32_t) * (height + 1), memory_pool);
+
+	size_t current = 0;
+	for (int y = 0; y < height; ++y) {
+		const tiled_index_t *row = &map[y * width];
+		row_runs->row_first[y] = current;
+		for (int x = 0; x < width; ++x) {
+			if (row[x] == TILED_EMPTY_TILE)
+				continue;
+
+			row_runs->runs[current].start = x;
+			while (x < width && row[x] != TILED_EMPTY_TILE)
+				++x;
+			row_runs->runs[current].end = x;
+			++current;
+		}
+	}
+	row_runs->row_first[height] = current;
+}
+
+// Only call this if 'tiled_row_runs_build' did not use a memory pool.
+static inline void tiled_row_runs_free(TiledRowRuns *row_runs) {
+	free(row_runs->runs);
+	free(row_runs->row_first);
+}
+
+// Returns the first span of row 'y' that ends after 'x' (or the end of the row, if none).
+static inline const TiledRun *tiled_row_runs_find(const TiledRowRuns *row_runs, int y, int x) {
+	uint32_t low = row_runs->row_first[y];
+	uint32_t high = row_runs->row_first[y + 1];
+	while (low < high) {
+		uint32_t middle = (low + high) / 2;
+		if (row_runs->runs[middle].end <= x)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return &row_runs->runs[low];
+}
@@ -0,0 +1,207 @@
+#include "../include/tiled_stream.h"
+
+#include "../include/memory_alloc.h"
+#include "tiled_bin_loader.h"
+
+// Range of chunks, from (x0, y0) up to (but not including) (x1, y1).
+typedef struct {
+	int x0, y0, x1, y1;
+} ChunkRange;
+
+#define RANGE_CONTAINS(RANGE, X, Y)                                                                \
+	((X) >= (RANGE).x0 && (X) < (RANGE).x1 && (Y) >= (RANGE).y0 && (Y) < (RANGE).y1)
+
+// Chunks that touch 'rect' grown by 'margin' pixels on every side, clamped to the map.
+static ChunkRange tiled_stream_range(TiledStream *tiled, Rect rect, int margin) {
+	int chunk_width = tiled->chunk_size.width * tiled->tile_size.width;
+	int chunk_height = tiled->chunk_size.height * tiled->tile_size.height;
+
+	int left = rect.pos.x - margin;
+	int top = rect.pos.y - margin;
+	int right = rect.pos.x + rect.size.width + margin;
+	int bottom = rect.pos.y + rect.size.height + margin;
+
+	ChunkRange range;
+	range.x0 = left > 0 ? left / chunk_width : 0;
+	range.y0 = top > 0 ? top / chunk_height : 0;
+	range.x1 = right > 0 ? right / chunk_width + 1 : 0;
+	range.y1 = bottom > 0 ? bottom / chunk_height + 1 : 0;
+	if (range.x1 > (int)tiled->chunks_per_row)
+		range.x1 = tiled->chunks_per_row;
+	if (range.y1 > (int)tiled->chunks_per_column)
+		range.y1 = tiled->chunks_per_column;
+	return range;
+}
+
+static TiledStreamChunk *tiled_stream_find(TiledStream *tiled, int chunk_x, int chunk_y) {
+	for (size_t i = 0; i < tiled->chunk_count; ++i) {
+		if (tiled->chunks[i].chunk_x == chunk_x && tiled->chunks[i].chunk_y == chunk_y)
+			return &tiled->chunks[i];
+	}
+	return NULL;
+}
+
+/*
+ * Loads a chunk into an empty slot, or into the least recently used one that is not inside 'keep'.
+ * Returns false if all slots have chunks inside 'keep'.
+ */
+static bool tiled_stream_load(TiledStream *tiled, int chunk_x, int chunk_y, ChunkRange keep) {
+	TiledStreamChunk *slot = NULL;
+	for (size_t i = 0; i < tiled->chunk_count; ++i) {
+		TiledStreamChunk *chunk = &tiled->chunks[i];
+		if (chunk->chunk_x < 0) {
+			slot = chunk;
+			break;
+		}
+		if (!RANGE_CONTAINS(keep, chunk->chunk_x, chunk->chunk_y) &&
+			(!slot || chunk->last_used < slot->last_used))
+			slot = chunk;
+	}
+	if (!slot)
+		return false;
+
+	size_t chunk_tiles = tiled->chunk_size.width * tiled->chunk_size.height;
+	size_t chunk_index = chunk_y * tiled->chunks_per_row + chunk_x;
+	size_t chunk_offset =
+		sizeof(TiledBinHeader) + chunk_index * chunk_tiles * sizeof(tiled_index_t);
+	dfs_seek(tiled->fp, chunk_offset, SEEK_SET);
+	tiled_bin_read_tiles(tiled->fp, slot->tiles, chunk_tiles);
+
+	slot->chunk_x = chunk_x;
+	slot->chunk_y = chunk_y;
+	slot->last_used = tiled->frame;
+	return true;
+}
+
+/*
+ * Loads up to 'max_loads' missing chunks of 'range', keeping the chunks of 'keep' in memory.
+ * Returns the amount of chunks loaded.
+ */
+static size_t tiled_stream_load_range(TiledStream *tiled, ChunkRange range, ChunkRange keep,
+									  size_t max_loads) {
+	size_t loads = 0;
+	for (int y = range.y0; y < range.y1; ++y) {
+		for (int x = range.x0; x < range.x1; ++x) {
+			if (loads >= max_loads)
+				return loads;
+
+			TiledStreamChunk *chunk = tiled_stream_find(tiled, x, y);
+			if (chunk) {
+				chunk->last_used = tiled->frame;
+				continue;
+			}
+
+			if (!tiled_stream_load(tiled, x, y, keep))
+				return loads;  // not enough chunks to keep everything around the screen
+			++loads;
+		}
+	}
+	return loads;
+}
+
+TiledStream *tiled_stream_init(MemZone *memory_pool, sprite_t *sprite, const char *map_path,
+							   size_t chunk_count, size_t loads_per_frame, int prefetch_margin) {
+	TiledBinHeader header;
+	int fp = tiled_bin_open(map_path, &header, TILED_BIN_FLAG_CHUNKED);
+
+	TiledStream *tiled = MEM_ALLOC(sizeof(TiledStream), memory_pool);
+	tiled->map_size = new_size(header.width, header.height);
+	tiled->tile_size = new_size(header.tile_width, header.tile_height);
+	tiled->chunk_size = new_size(header.chunk_width, header.chunk_height);
+	tiled->chunks_per_row = (header.width + header.chunk_width - 1) / header.chunk_width;
+	tiled->chunks_per_column = (header.height + header.chunk_height - 1) / header.chunk_height;
+	tiled->loads_per_frame = loads_per_frame;
+	tiled->prefetch_margin = prefetch_margin;
+	tiled->frame = 0;
+	tiled->fp = fp;
+	tiled->sprite = sprite;
+	tiled->memory_pool = memory_pool;
+
+	// all chunks are allocated once, and replaced while the screen moves
+	size_t chunk_tiles = header.chunk_width * header.chunk_height;
+	tiled->chunk_count = chunk_count;
+	tiled->chunks = MEM_ALLOC(sizeof(TiledStreamChunk) * chunk_count, memory_pool);
+	tiled_index_t *tiles =
+		MEM_ALLOC(chunk_tiles * chunk_count * sizeof(tiled_index_t), memory_pool);
+	for (size_t i = 0; i < chunk_count; ++i) {
+		tiled->chunks[i].tiles = tiles + i * chunk_tiles;
+		tiled->chunks[i].chunk_x = -1;
+		tiled->chunks[i].chunk_y = -1;
+		tiled->chunks[i].last_used = 0;
+	}
+
+	return tiled;
+}
+
+void tiled_stream_preload(TiledStream *tiled, Rect screen_rect) {
+	ChunkRange visible = tiled_stream_range(tiled, screen_rect, 0);
+	tiled_stream_load_range(tiled, visible, visible, tiled->chunk_count);
+}
+
+void tiled_stream_render_rdp(TiledStream *tiled, Rect screen_rect) {
+	++tiled->frame;
+
+	// visible chunks are loaded first, then the ones about to become visible
+	ChunkRange visible = tiled_stream_range(tiled, screen_rect, 0);
+	ChunkRange prefetch = tiled_stream_range(tiled, screen_rect, tiled->prefetch_margin);
+	size_t loads = tiled_stream_load_range(tiled, visible, prefetch, tiled->loads_per_frame);
+	tiled_stream_load_range(tiled, prefetch, prefetch, tiled->loads_per_frame - loads);
+
+	rdp_sync(SYNC_PIPE);
+
+	int tile_width = tiled->tile_size.width;
+	int tile_height = tiled->tile_size.height;
+	int chunk_width = tiled->chunk_size.width;
+	int chunk_height = tiled->chunk_size.height;
+
+	int initial_x = screen_rect.pos.x > 0 ? screen_rect.pos.x / tile_width : 0;
+	int initial_y = screen_rect.pos.y > 0 ? screen_rect.pos.y / tile_height : 0;
+	int final_x = ((screen_rect.pos.x + screen_rect.size.width) / tile_width) + 1;
+	int final_y = ((screen_rect.pos.y + screen_rect.size.height) / tile_height) + 1;
+
+	int last_tile = -1;
+	for (int chunk_y = visible.y0; chunk_y < visible.y1; ++chunk_y) {
+		for (int chunk_x = visible.x0; chunk_x < visible.x1; ++chunk_x) {
+			TiledStreamChunk *chunk = tiled_stream_find(tiled, chunk_x, chunk_y);
+			if (!chunk)
+				continue;
+
+			// tiles of the chunk that are on the screen
+			int start_x = chunk_x * chunk_width;
+			int start_y = chunk_y * chunk_height;
+			int x0 = initial_x > start_x ? initial_x : start_x;
+			int y0 = initial_y > start_y ? initial_y : start_y;
+			int x1 = final_x < start_x + chunk_width ? final_x : start_x + chunk_width;
+			int y1 = final_y < start_y + chunk_height ? final_y : start_y + chunk_height;
+
+			for (int y = y0; y < y1; ++y) {
+				tiled_index_t *row = &chunk->tiles[(y - start_y) * chunk_width];
+				for (int x = x0; x < x1; ++x) {
+					tiled_index_t tile = row[x - start_x];
+					if (tile == TILED_EMPTY_TILE)
+						continue;
+
+					if (last_tile != tile) {
+						last_tile = tile;
+						rdp_load_texture_stride(0, 0, MIRROR_DISABLED, tiled->sprite, tile);
+					}
+
+					rdp_draw_textured_rectangle(0, x * tile_width, y * tile_height,
+												x * tile_width + tile_width,
+												y * tile_height + tile_height, MIRROR_DISABLED);
+				}
+			}
+		}
+	}
+}
+
+void tiled_stream_destroy(TiledStream *tiled) {
+	dfs_close(tiled->fp);
+
+	if (tiled->memory_pool)
+		return;
+
+	free(tiled->chunks[0].tiles);
+	free(tiled->chunks);
+	free(tiled);
+}
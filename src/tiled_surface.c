@@ -0,0 +1,152 @@
+#include "../include/tiled_surface.h"
+
+#include "../include/memory_alloc.h"
+#include "tiled_blit.h"
+#include "tiled_render.h"
+
+// Division rounding down, also for negative numbers.
+static inline int floor_div(int value, int divisor) {
+	return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/*
+ * Clears and draws the tiles on the area of the surface from (x, y) with size (width, height).
+ * Tiles that are partially inside the area are drawn whole, which does not change the pixels
+ * outside of the area since they already have the same tile.
+ */
+static void tiled_surface_draw_area(TiledSurface *surface, int x, int y, int width, int height) {
+	sprite_t *sprite = surface->surface;
+	if (x < 0) {
+		width += x;
+		x = 0;
+	}
+	if (y < 0) {
+		height += y;
+		y = 0;
+	}
+	if (x + width > sprite->width)
+		width = sprite->width - x;
+	if (y + height > sprite->height)
+		height = sprite->height - y;
+	if (width <= 0 || height <= 0)
+		return;
+
+	tiled_blit_clear(sprite, x, y, width, height);
+
+	Tiled *tiled = surface->tiled;
+	int tile_width = tiled->tile_size.width;
+	int tile_height = tiled->tile_size.height;
+
+	TiledView view;
+	view.initial_x = floor_div(surface->x + x, tile_width);
+	view.initial_y = floor_div(surface->y + y, tile_height);
+	view.final_x = floor_div(surface->x + x + width - 1, tile_width) + 1;
+	view.final_y = floor_div(surface->y + y + height - 1, tile_height) + 1;
+	if (view.initial_x < 0)
+		view.initial_x = 0;
+	if (view.initial_y < 0)
+		view.initial_y = 0;
+	if (view.final_x > tiled->map_size.width)
+		view.final_x = tiled->map_size.width;
+	if (view.final_y > tiled->map_size.height)
+		view.final_y = tiled->map_size.height;
+	view.offset_x = -surface->x;
+	view.offset_y = -surface->y;
+
+	TILED_BEGIN_LOOP(tiled->map, tiled->map_size, &tiled->row_runs, &view)
+
+	tiled_blit_tile(sprite, tiled->sprite, tile, x * tile_width + view.offset_x,
+					y * tile_height + view.offset_y);
+
+	TILED_END_LOOP()
+}
+
+TiledSurface *tiled_surface_init(MemZone *memory_pool, Tiled *tiled, Size screen_size) {
+	if (!TILED_BLIT_SUPPORTED(tiled->sprite))
+		abort();  // Only 16 and 32 bits sprites can be drawn to the surface.
+
+	TiledSurface *surface = MEM_ALLOC(sizeof(TiledSurface), memory_pool);
+	surface->tiled = tiled;
+	surface->x = 0;
+	surface->y = 0;
+	surface->valid = false;
+	surface->dirty_count = 0;
+
+	int width = screen_size.width;
+	int height = screen_size.height;
+	int bitdepth = tiled->sprite->bitdepth;
+	surface->surface = MEM_ALLOC(sizeof(sprite_t) + width * height * bitdepth, memory_pool);
+	surface->surface->width = width;
+	surface->surface->height = height;
+	surface->surface->bitdepth = bitdepth;
+	surface->surface->format = tiled->sprite->format;
+	surface->surface->hslices = 1;
+	surface->surface->vslices = 1;
+
+	return surface;
+}
+
+void tiled_surface_mark_dirty(TiledSurface *surface, int tile_x, int tile_y) {
+	if (surface->dirty_count == TILED_SURFACE_MAX_DIRTY) {
+		surface->valid = false;
+		return;
+	}
+
+	surface->dirty[surface->dirty_count] = new_position_int(tile_x, tile_y);
+	++surface->dirty_count;
+}
+
+void tiled_surface_invalidate(TiledSurface *surface) {
+	surface->valid = false;
+}
+
+void tiled_surface_render(display_context_t disp, TiledSurface *surface, Rect screen_rect) {
+	sprite_t *sprite = surface->surface;
+	int x = screen_rect.pos.x;
+	int y = screen_rect.pos.y;
+	// round down for negative positions as well
+	if (x > screen_rect.pos.x)
+		--x;
+	if (y > screen_rect.pos.y)
+		--y;
+
+	int dx = x - surface->x;
+	int dy = y - surface->y;
+	surface->x = x;
+	surface->y = y;
+
+	if (!surface->valid || dx >= sprite->width || -dx >= sprite->width ||
+		dy >= sprite->height || -dy >= sprite->height) {
+		tiled_surface_draw_area(surface, 0, 0, sprite->width, sprite->height);
+		surface->valid = true;
+	} else {
+		if (dx != 0 || dy != 0)
+			tiled_blit_scroll(sprite, dx, dy);
+
+		// only the rows and columns that became visible
+		if (dy > 0)
+			tiled_surface_draw_area(surface, 0, sprite->height - dy, sprite->width, dy);
+		else if (dy < 0)
+			tiled_surface_draw_area(surface, 0, 0, sprite->width, -dy);
+		if (dx > 0)
+			tiled_surface_draw_area(surface, sprite->width - dx, 0, dx, sprite->height);
+		else if (dx < 0)
+			tiled_surface_draw_area(surface, 0, 0, -dx, sprite->height);
+
+		int tile_width = surface->tiled->tile_size.width;
+		int tile_height = surface->tiled->tile_size.height;
+		for (size_t i = 0; i < surface->dirty_count; ++i) {
+			tiled_surface_draw_area(surface, surface->dirty[i].x * tile_width - x,
+									surface->dirty[i].y * tile_height - y, tile_width,
+									tile_height);
+		}
+	}
+	surface->dirty_count = 0;
+
+	graphics_draw_sprite_trans(disp, x, y, sprite);
+}
+
+void tiled_surface_destroy(TiledSurface *surface) {
+	free(surface->surface);
+	free(surface);
+}
@@ -0,0 +1,74 @@
+/**
+ * @file bench_tiled_cached.c
+ * @brief Load time of 'tiled_cached_init_bin' for maps of increasing size, using malloc and a
+ * MemZone. Maps are random, with a quarter of the tiles empty.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <libdragon.h>
+#include "../include/tiled_bin.h"
+#include "../include/tiled_cached.h"
+
+#define BENCH_MAP_PATH "bench_tiled_cached.bin"
+#define BENCH_RUNS 10
+
+// Writes a random map of 'size' x 'size' tiles, read back in the byte order of the host.
+static void write_map(int size) {
+	TiledBinHeader header = {0};
+	header.magic = TILED_BIN_MAGIC;
+	header.version = TILED_BIN_VERSION;
+	header.width = size;
+	header.height = size;
+	header.tile_width = 16;
+	header.tile_height = 16;
+	header.layer_count = 1;
+	header.index_bytes = sizeof(tiled_index_t);
+
+	FILE *file = fopen(BENCH_MAP_PATH, "wb");
+	fwrite(&header, sizeof(header), 1, file);
+	for (int i = 0; i < size * size; ++i) {
+		tiled_index_t tile = rand() % 4 == 0 ? TILED_EMPTY_TILE : rand() % 254;
+		fwrite(&tile, sizeof(tile), 1, file);
+	}
+	fclose(file);
+}
+
+static double now_ms(void) {
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec * 1000.0 + time.tv_nsec / 1000000.0;
+}
+
+int main(void) {
+	srand(1);
+	printf("%-10s %12s %12s\n", "map", "malloc (ms)", "MemZone (ms)");
+	for (int size = 64; size <= 512; size *= 2) {
+		write_map(size);
+
+		double start = now_ms();
+		for (int run = 0; run < BENCH_RUNS; ++run) {
+			// dfs paths drop their first character (see 'stub/libdragon.h')
+			TiledCached *cached = tiled_cached_init_bin(NULL, NULL, "/" BENCH_MAP_PATH);
+			tiled_cached_destroy(cached);
+		}
+		double malloc_ms = (now_ms() - start) / BENCH_RUNS;
+
+		// enough for the positions, groups and loading buffers of a map with no repeated tiles
+		MemZone zone;
+		mem_zone_init(&zone, (size_t)size * size * 32 + 64 * 1024);
+		start = now_ms();
+		for (int run = 0; run < BENCH_RUNS; ++run) {
+			tiled_cached_init_bin(&zone, NULL, "/" BENCH_MAP_PATH);
+			mem_zone_free_all(&zone);
+		}
+		double zone_ms = (now_ms() - start) / BENCH_RUNS;
+		mem_zone_destroy(&zone);
+
+		printf("%4dx%-5d %12.2f %12.2f\n", size, size, malloc_ms, zone_ms);
+	}
+	remove(BENCH_MAP_PATH);
+	return 0;
+}
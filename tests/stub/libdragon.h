@@ -0,0 +1,79 @@
+/**
+ * @file libdragon.h
+ * @brief Minimal host stand-in for the parts of libdragon used by the library, so its modules can
+ * be tested and benchmarked on the host. Drawing functions do nothing.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef int display_context_t;
+
+typedef struct {
+	uint16_t width;
+	uint16_t height;
+	uint8_t bitdepth;
+	uint8_t format;
+	uint8_t hslices;
+	uint8_t vslices;
+	uint32_t data[0];
+} sprite_t;
+
+typedef struct {
+	uint8_t r, g, b, a;
+} color_t;
+
+struct controller_data {
+	int c[4];
+};
+
+typedef enum { MIRROR_DISABLED, MIRROR_X, MIRROR_Y, MIRROR_XY } mirror_t;
+typedef enum { SYNC_FULL, SYNC_PIPE, SYNC_LOAD, SYNC_TILE } sync_t;
+
+// Files are read from the host file system (the first character of the path is dropped, so
+// "/map.bin" reads "map.bin" and "//tmp/map.bin" reads "/tmp/map.bin").
+int dfs_open(const char *path);
+int dfs_read(void *buf, int size, int count, uint32_t handle);
+int dfs_seek(uint32_t handle, int offset, int origin);
+int dfs_tell(uint32_t handle);
+int dfs_size(uint32_t handle);
+int dfs_close(uint32_t handle);
+
+void disable_interrupts(void);
+void enable_interrupts(void);
+unsigned long get_ticks_ms(void);
+unsigned long get_ticks(void);
+struct controller_data get_keys_down(void);
+
+void graphics_draw_sprite(display_context_t disp, int x, int y, sprite_t *sprite);
+void graphics_draw_sprite_stride(display_context_t disp, int x, int y, sprite_t *sprite,
+								 int offset);
+void graphics_draw_sprite_trans(display_context_t disp, int x, int y, sprite_t *sprite);
+void graphics_draw_sprite_trans_stride(display_context_t disp, int x, int y, sprite_t *sprite,
+									   int offset);
+void graphics_draw_text(display_context_t disp, int x, int y, const char *msg);
+uint32_t graphics_make_color(int r, int g, int b, int a);
+void graphics_set_color(uint32_t forecolor, uint32_t backcolor);
+void graphics_fill_screen(display_context_t disp, uint32_t color);
+void graphics_draw_box(display_context_t disp, int x, int y, int width, int height,
+					   uint32_t color);
+
+void rdp_sync(sync_t sync);
+void rdp_attach_display(display_context_t disp);
+void rdp_detach_display(void);
+void rdp_set_default_clipping(void);
+void rdp_enable_texture_copy(void);
+void rdp_enable_blend_fill(void);
+void rdp_set_blend_color(uint32_t color);
+void rdp_draw_filled_triangle(float x1, float y1, float x2, float y2, float x3, float y3);
+uint32_t rdp_load_texture(int texslot, uint32_t texloc, mirror_t mirror, sprite_t *sprite);
+uint32_t rdp_load_texture_stride(int texslot, uint32_t texloc, mirror_t mirror, sprite_t *sprite,
+								 int offset);
+void rdp_draw_sprite(int texslot, int x, int y, mirror_t mirror);
+void rdp_draw_textured_rectangle(int texslot, int tx, int ty, int bx, int by, mirror_t mirror);
+void rdp_draw_textured_rectangle_scaled(int texslot, int tx, int ty, int bx, int by, double x_scale,
+										double y_scale, mirror_t mirror);
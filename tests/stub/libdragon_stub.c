@@ -0,0 +1,75 @@
+#include <libdragon.h>
+
+#include <stdio.h>
+#include <time.h>
+#include "../../include/position.h"
+#include "../../include/position_int.h"
+#include "../../include/size.h"
+
+// Definitions of the inline helpers, for calls the compiler did not inline.
+extern inline Position new_position_same(float x_and_y);
+extern inline PositionInt new_position_int(int x, int y);
+extern inline Size new_size(float width, float height);
+
+#define DFS_MAX_FILES 8
+
+static FILE *dfs_files[DFS_MAX_FILES];
+
+int dfs_open(const char *path) {
+	for (int i = 1; i < DFS_MAX_FILES; ++i) {
+		if (!dfs_files[i]) {
+			dfs_files[i] = fopen(path + 1, "rb");
+			return dfs_files[i] ? i : -1;
+		}
+	}
+	return -1;
+}
+
+int dfs_read(void *buf, int size, int count, uint32_t handle) {
+	return fread(buf, 1, size * count, dfs_files[handle]);
+}
+
+int dfs_seek(uint32_t handle, int offset, int origin) {
+	return fseek(dfs_files[handle], offset, origin);
+}
+
+int dfs_tell(uint32_t handle) {
+	return ftell(dfs_files[handle]);
+}
+
+int dfs_size(uint32_t handle) {
+	long pos = ftell(dfs_files[handle]);
+	fseek(dfs_files[handle], 0, SEEK_END);
+	long size = ftell(dfs_files[handle]);
+	fseek(dfs_files[handle], pos, SEEK_SET);
+	return size;
+}
+
+int dfs_close(uint32_t handle) {
+	fclose(dfs_files[handle]);
+	dfs_files[handle] = NULL;
+	return 0;
+}
+
+void disable_interrupts(void) {}
+void enable_interrupts(void) {}
+
+unsigned long get_ticks_ms(void) {
+	return clock() * 1000 / CLOCKS_PER_SEC;
+}
+
+unsigned long get_ticks(void) {
+	return clock();
+}
+
+void rdp_sync(sync_t sync) {}
+
+uint32_t rdp_load_texture_stride(int texslot, uint32_t texloc, mirror_t mirror, sprite_t *sprite,
+								 int offset) {
+	return 0;
+}
+
+void rdp_draw_textured_rectangle(int texslot, int tx, int ty, int bx, int by, mirror_t mirror) {}
+
+void graphics_draw_sprite_trans_stride(display_context_t disp, int x, int y, sprite_t *sprite,
+									   int offset) {}
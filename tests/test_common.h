@@ -0,0 +1,50 @@
+/**
+ * @file test_common.h
+ * @brief Helpers shared by the host tests.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static int test_failures = 0;
+
+// Reports a failed check and keeps running the test.
+#define CHECK(COND)                                                                                \
+	do {                                                                                           \
+		if (!(COND)) {                                                                             \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #COND);               \
+			++test_failures;                                                                       \
+		}                                                                                          \
+	} while (0)
+
+// Runs 'fn' on a child process and returns true if it aborted (eg.: a failed assert).
+static inline bool test_aborts(void (*fn)(void)) {
+	fflush(stdout);
+	fflush(stderr);
+	pid_t pid = fork();
+	if (pid == 0) {
+		// the expected assert message is not useful on the output
+		freopen("/dev/null", "w", stderr);
+		fn();
+		exit(0);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+	return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+}
+
+// Returns the exit code of the test, printing its result.
+static inline int test_result(const char *name) {
+	if (test_failures) {
+		printf("%s: %d checks failed\n", name, test_failures);
+		return 1;
+	}
+	printf("%s: ok\n", name);
+	return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file test_mem_heap.c
+ * @brief MemHeap stats, checking the biggest allocation reported can be done.
+ */
+
+#include "test_common.h"
+
+#include <libdragon.h>
+#include "../include/mem_heap.h"
+
+// Checks that 'largest_alloc' can be allocated, and that anything bigger fails.
+static void check_largest_alloc(MemHeap *heap) {
+	MemHeapStats stats;
+	mem_heap_get_stats(heap, &stats);
+	CHECK(stats.largest_alloc <= stats.largest_free_block);
+
+	void *too_big = mem_heap_alloc(heap, stats.largest_alloc + 1);
+	CHECK(too_big == NULL);
+	mem_heap_free(heap, too_big);
+
+	void *data = mem_heap_alloc(heap, stats.largest_alloc);
+	CHECK(data != NULL);
+	mem_heap_free(heap, data);
+}
+
+static void test_largest_alloc(size_t size) {
+	MemHeap *heap = mem_heap_init(NULL, size);
+	check_largest_alloc(heap);
+
+	// with some blocks in use, the biggest free block is somewhere in the middle
+	void *a = mem_heap_alloc(heap, size / 8);
+	void *b = mem_heap_alloc(heap, size / 3);
+	void *c = mem_heap_alloc(heap, 100);
+	mem_heap_free(heap, b);
+	check_largest_alloc(heap);
+
+	mem_heap_free(heap, a);
+	mem_heap_free(heap, c);
+	mem_heap_destroy(heap);
+}
+
+int main(void) {
+	test_largest_alloc(1024);
+	test_largest_alloc(64 * 1024);
+	test_largest_alloc(1024 * 1024);
+	test_largest_alloc(1000 * 1000);
+	return test_result("test_mem_heap");
+}
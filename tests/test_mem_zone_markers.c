@@ -0,0 +1,114 @@
+/**
+ * @file test_mem_zone_markers.c
+ * @brief Nested MemZone markers mixed with object pools allocated from the same zone.
+ */
+
+#include "test_common.h"
+
+#include <libdragon.h>
+#include "../include/mem_pool.h"
+#include "../include/object_pool.h"
+
+typedef struct {
+	int x;
+	int y;
+} Point;
+
+OBJPOOL_INIT(Point)
+
+static void test_nested_markers(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 16 * 1024);
+
+	mem_zone_alloc(&zone, 10);
+	size_t used_base = zone.pos - zone.start;
+
+	MemZoneMarker outer = mem_zone_mark(&zone);
+	objpool_t(Point) *level_pool = objpool_create(Point, &zone, 16);
+	size_t used_level = zone.pos - zone.start;
+
+	MemZoneMarker inner = mem_zone_mark(&zone);
+	objpool_t(Point) *room_pool = objpool_create(Point, &zone, 8);
+	Point *point = objpool_get(Point, room_pool);
+	point->x = 1;
+	mem_zone_alloc(&zone, 100);
+
+	// the inner pool goes away, the outer one is still usable
+	mem_zone_rewind_to(&zone, inner);
+	CHECK((size_t)(zone.pos - zone.start) == used_level);
+	Point *level_point = objpool_get(Point, level_pool);
+	CHECK(level_point != NULL);
+	level_point->y = 2;
+
+	// the same depth can be marked again after a rewind
+	MemZoneMarker again = mem_zone_mark(&zone);
+	CHECK(again.depth == inner.depth);
+	room_pool = objpool_create(Point, &zone, 8);
+	CHECK(objpool_get(Point, room_pool) != NULL);
+	mem_zone_rewind_to(&zone, again);
+
+	mem_zone_rewind_to(&zone, outer);
+	CHECK((size_t)(zone.pos - zone.start) == used_base);
+	CHECK(zone.marker_depth == 0);
+
+	mem_zone_destroy(&zone);
+}
+
+static void test_top_markers(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 16 * 1024);
+
+	char *top = zone.top;
+	MemZoneMarker marker = mem_zone_mark_top(&zone);
+	mem_zone_alloc_top(&zone, 64);
+	objpool_create(Point, &zone, 8);
+	mem_zone_rewind_top_to(&zone, marker);
+	CHECK(zone.top == top);
+
+	mem_zone_destroy(&zone);
+}
+
+// mark A, mark B, rewind A, mark C, mark D, rewind B: B has the depth of D, but was discarded.
+static void rewind_stale_marker(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 4096);
+	MemZoneMarker a = mem_zone_mark(&zone);
+	MemZoneMarker b = mem_zone_mark(&zone);
+	mem_zone_rewind_to(&zone, a);
+	mem_zone_mark(&zone);
+	mem_zone_mark(&zone);
+	mem_zone_rewind_to(&zone, b);
+}
+
+// Same as 'rewind_stale_marker' on the top of the zone.
+static void rewind_stale_top_marker(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 4096);
+	MemZoneMarker a = mem_zone_mark_top(&zone);
+	MemZoneMarker b = mem_zone_mark_top(&zone);
+	mem_zone_rewind_top_to(&zone, a);
+	mem_zone_mark_top(&zone);
+	mem_zone_mark_top(&zone);
+	mem_zone_rewind_top_to(&zone, b);
+}
+
+// Rewinds a marker after 'mem_zone_free_all' opened a new marker on its depth.
+static void rewind_after_free_all(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 4096);
+	MemZoneMarker a = mem_zone_mark(&zone);
+	mem_zone_free_all(&zone);
+	mem_zone_mark(&zone);
+	mem_zone_rewind_to(&zone, a);
+}
+
+int main(void) {
+	test_nested_markers();
+	test_top_markers();
+#ifndef NDEBUG
+	CHECK(test_aborts(rewind_stale_marker));
+	CHECK(test_aborts(rewind_stale_top_marker));
+	CHECK(test_aborts(rewind_after_free_all));
+#endif
+	return test_result("test_mem_zone_markers");
+}
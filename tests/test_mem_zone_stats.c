@@ -0,0 +1,45 @@
+/**
+ * @file test_mem_zone_stats.c
+ * @brief MemZone stats (built with MEM_ZONE_STATS).
+ */
+
+#include "test_common.h"
+
+#include <libdragon.h>
+#include "../include/mem_pool.h"
+
+static void test_realloc_across_chunks(void) {
+	MemZone zone;
+	mem_zone_init_chained(&zone, 256, 1024, 0);
+
+	char *data = mem_zone_alloc(&zone, 100);
+	CHECK(zone.stats.alloc_count == 1);
+	CHECK(zone.stats.current_bytes >= 112);
+	CHECK(zone.stats.wasted_bytes == 12);
+
+	// grows in place
+	data = mem_zone_realloc_last(&zone, data, 200);
+	CHECK(zone.stats.alloc_count == 1);
+	CHECK(zone.stats.current_bytes >= 208);
+	CHECK(zone.stats.wasted_bytes == 8);
+	size_t old_block = zone.stats.current_bytes;
+
+	// moves to a new chunk: still one allocation, and the old block is wasted
+	data = mem_zone_realloc_last(&zone, data, 600);
+	CHECK(data != NULL);
+	CHECK(zone.stats.alloc_count == 1);
+	CHECK(zone.stats.current_bytes >= old_block + 608);
+	CHECK(zone.stats.wasted_bytes == old_block + 8);
+
+	mem_zone_free_all(&zone);
+	CHECK(zone.stats.alloc_count == 0);
+	CHECK(zone.stats.current_bytes == 0);
+	CHECK(zone.stats.wasted_bytes == 0);
+
+	mem_zone_destroy(&zone);
+}
+
+int main(void) {
+	test_realloc_across_chunks();
+	return test_result("test_mem_zone_stats");
+}
@@ -0,0 +1,282 @@
+/**
+ * @file test_object_pool.c
+ * @brief Object pools, including pools that grow to more than one block.
+ */
+
+#include "test_common.h"
+
+#include <libdragon.h>
+#include "../include/object_pool.h"
+
+typedef struct {
+	int x;
+	int y;
+} Point;
+
+OBJPOOL_INIT(Point)
+
+static void test_growable(MemZone *memory_pool) {
+	objpool_t(Point) *pool = objpool_create_growable(Point, memory_pool, 4, 8);
+
+	// 4 + 8 * 5 objects, so the pool has 6 blocks
+	Point *points[44];
+	for (int i = 0; i < 44; ++i) {
+		points[i] = objpool_get(Point, pool);
+		CHECK(points[i] != NULL);
+		points[i]->x = i;
+	}
+	CHECK(objpool_block_count(pool) == 6);
+
+	// objects of every block are freed once
+	for (int i = 0; i < 44; i += 3) {
+		CHECK(objpool_free(Point, pool, points[i]));
+		CHECK(!objpool_free(Point, pool, points[i]));
+	}
+	for (int i = 1; i < 44; i += 3) {
+		CHECK(points[i]->x == i);
+	}
+
+	// freed objects are reused before growing again
+	for (int i = 0; i < 44; i += 3) {
+		points[i] = objpool_get(Point, pool);
+		CHECK(points[i] != NULL);
+	}
+	CHECK(objpool_block_count(pool) == 6);
+
+	for (int i = 0; i < 44; ++i) {
+		CHECK(objpool_free(Point, pool, points[i]));
+	}
+
+	// objects from another pool of the same type are rejected
+	objpool_t(Point) *other = objpool_create_growable(Point, memory_pool, 1, 1);
+	objpool_get(Point, other);
+	Point *other_point = objpool_get(Point, other);
+	CHECK(!objpool_free(Point, pool, other_point));
+	CHECK(objpool_free(Point, other, other_point));
+
+	if (!memory_pool) {
+		objpool_destroy(Point, other);
+		objpool_destroy(Point, pool);
+	}
+}
+
+static void test_fixed_size(void) {
+	objpool_t(Point) *pool = objpool_create(Point, NULL, 2);
+	CHECK(objpool_get(Point, pool) != NULL);
+	CHECK(objpool_get(Point, pool) != NULL);
+	CHECK(objpool_get(Point, pool) == NULL);
+	CHECK(objpool_block_count(pool) == 1);
+
+	// 'items' and 'num' still have the objects given on create
+	CHECK(pool->num == 2);
+	CHECK(objpool_free(Point, pool, &pool->items[1].data));
+
+	// pools that do not grow can check any pointer
+	Point outside;
+	CHECK(!objpool_free(Point, pool, &outside));
+	objpool_destroy(Point, pool);
+}
+
+static void test_foreach(void) {
+	objpool_t(Point) *pool = objpool_create(Point, NULL, 100);
+	Point *points[100];
+	for (int i = 0; i < 100; ++i) {
+		points[i] = objpool_get(Point, pool);
+		points[i]->x = i;
+	}
+	// leaves 1 of every 3 objects (a whole bitmap word is free from 40 to 80)
+	for (int i = 0; i < 100; ++i) {
+		if (i % 3 != 0 || (i >= 40 && i < 80)) {
+			objpool_free(Point, pool, points[i]);
+		}
+	}
+
+	int count = 0;
+	int last = -1;
+	objpool_foreach(Point, pool, point) {
+		CHECK(point->x % 3 == 0 && (point->x < 40 || point->x >= 80));
+		CHECK(point->x > last);
+		last = point->x;
+		++count;
+	}
+	CHECK(count == 21);
+
+	// freeing the current object (and objects already visited) during the walk
+	count = 0;
+	objpool_foreach(Point, pool, point) {
+		++count;
+		if (point->x % 2 == 0) {
+			CHECK(objpool_free(Point, pool, point));
+		}
+	}
+	CHECK(count == 21);
+	count = 0;
+	objpool_foreach(Point, pool, point) {
+		CHECK(point->x % 2 != 0);
+		++count;
+	}
+	CHECK(count == 11);
+
+	objpool_destroy(Point, pool);
+}
+
+static void test_foreach_address_order(void) {
+	// a big first block (usually mapped apart from the heap) and small blocks after it, which may
+	// be at lower addresses
+	objpool_t(Point) *pool = objpool_create_growable(Point, NULL, 20000, 4);
+	for (int i = 0; i < 20000 + 4 * 8; ++i) {
+		objpool_get(Point, pool)->x = i;
+	}
+	CHECK(objpool_block_count(pool) == 9);
+
+	int count = 0;
+	Point *last = NULL;
+	objpool_foreach(Point, pool, point) {
+		CHECK((uintptr_t)point > (uintptr_t)last);
+		last = point;
+		++count;
+	}
+	CHECK(count == 20000 + 4 * 8);
+
+	objpool_destroy(Point, pool);
+}
+
+static void test_get_free_n(void) {
+	objpool_t(Point) *pool = objpool_create(Point, NULL, 10);
+	Point *first[6];
+	Point *second[6];
+
+	CHECK(objpool_get_n(Point, pool, first, 6) == 6);
+	// only 4 left
+	CHECK(objpool_get_n(Point, pool, second, 6) == 4);
+	CHECK(objpool_get(Point, pool) == NULL);
+	for (int i = 0; i < 6; ++i) {
+		for (int j = 0; j < 4; ++j) {
+			CHECK(first[i] != second[j]);
+		}
+	}
+
+	// objects already freed (or repeated) are skipped
+	CHECK(objpool_free(Point, pool, first[0]));
+	first[1] = first[2];
+	CHECK(objpool_free_n(Point, pool, first, 6) == 4);
+	CHECK(objpool_get_n(Point, pool, first, 6) == 5);
+
+	// an empty pool that can grow gives all of them
+	objpool_t(Point) *growable = objpool_create_growable(Point, NULL, 2, 3);
+	Point *burst[10];
+	CHECK(objpool_get_n(Point, growable, burst, 10) == 10);
+	CHECK(objpool_block_count(growable) == 4);
+	CHECK(objpool_free_n(Point, growable, burst, 10) == 10);
+
+	objpool_destroy(Point, growable);
+	objpool_destroy(Point, pool);
+}
+
+static void test_address_ordered(void) {
+	objpool_t(Point) *pool = objpool_create_growable(Point, NULL, 8, 4);
+	objpool_set_address_ordered(Point, pool, true);
+
+	Point *points[8];
+	for (int i = 0; i < 8; ++i) {
+		points[i] = objpool_get(Point, pool);
+		CHECK(points[i] == &pool->items[i].data);
+	}
+
+	// the lowest free object is reused, not the last one freed
+	objpool_free(Point, pool, points[5]);
+	objpool_free(Point, pool, points[2]);
+	objpool_free(Point, pool, points[6]);
+	CHECK(objpool_get(Point, pool) == points[2]);
+	CHECK(objpool_get(Point, pool) == points[5]);
+	CHECK(objpool_get(Point, pool) == points[6]);
+
+	// full, so it grows (the new block is filled, since it can be below the first one)
+	for (int i = 0; i < 4; ++i) {
+		CHECK(objpool_get(Point, pool) != NULL);
+	}
+	CHECK(objpool_block_count(pool) == 2);
+	objpool_free(Point, pool, points[3]);
+	CHECK(objpool_get(Point, pool) == points[3]);
+
+	// back to the free list, which is rebuilt in address order
+	objpool_free(Point, pool, points[7]);
+	objpool_free(Point, pool, points[1]);
+	objpool_set_address_ordered(Point, pool, false);
+	CHECK(objpool_get(Point, pool) == points[1]);
+	CHECK(objpool_get(Point, pool) == points[7]);
+
+	objpool_destroy(Point, pool);
+}
+
+typedef struct {
+	Point *tracked[16];
+	int calls;
+} RelocateLog;
+
+// Updates the tracked pointers to moved objects.
+static void on_relocate(void *old_obj, void *new_obj, void *user) {
+	RelocateLog *log = user;
+	for (int i = 0; i < 16; ++i) {
+		if (log->tracked[i] == old_obj) {
+			log->tracked[i] = new_obj;
+		}
+	}
+	CHECK(((Point *)new_obj)->y == ((Point *)old_obj)->y);
+	++log->calls;
+}
+
+static void test_compact(void) {
+	objpool_t(Point) *pool = objpool_create(Point, NULL, 16);
+	RelocateLog log = {{0}, 0};
+	for (int i = 0; i < 16; ++i) {
+		log.tracked[i] = objpool_get(Point, pool);
+		log.tracked[i]->y = i;
+	}
+	// keeps 3, 7, 8, 12 and 15
+	for (int i = 0; i < 16; ++i) {
+		if (i != 3 && i != 7 && i != 8 && i != 12 && i != 15) {
+			objpool_free(Point, pool, log.tracked[i]);
+			log.tracked[i] = NULL;
+		}
+	}
+
+	CHECK(objpool_compact(Point, pool, on_relocate, &log) == 5);
+	CHECK(log.calls == 5);
+
+	// packed at the front, in the same order, and the pointers were updated
+	int kept[] = {3, 7, 8, 12, 15};
+	for (int i = 0; i < 5; ++i) {
+		CHECK(log.tracked[kept[i]] == &pool->items[i].data);
+		CHECK(log.tracked[kept[i]]->y == kept[i]);
+	}
+	int count = 0;
+	objpool_foreach(Point, pool, point) {
+		CHECK(point == &pool->items[count].data);
+		++count;
+	}
+	CHECK(count == 5);
+
+	// nothing to move the second time, and new objects come after the packed ones
+	CHECK(objpool_compact(Point, pool, on_relocate, &log) == 0);
+	CHECK(objpool_get(Point, pool) == &pool->items[5].data);
+
+	objpool_destroy(Point, pool);
+}
+
+int main(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 16 * 1024);
+
+	test_growable(NULL);
+	test_growable(&zone);
+	test_fixed_size();
+	test_foreach();
+	test_foreach_address_order();
+	test_get_free_n();
+	test_address_ordered();
+	test_compact();
+
+	mem_zone_destroy(&zone);
+	return test_result("test_object_pool");
+}
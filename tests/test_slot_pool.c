@@ -0,0 +1,103 @@
+/**
+ * @file test_slot_pool.c
+ * @brief Slot pool handles, checking that freed and unused slots never resolve.
+ */
+
+#include "test_common.h"
+
+#include <libdragon.h>
+#include "../include/slot_pool.h"
+
+typedef struct {
+	int x;
+	int y;
+} Point;
+
+SLOTPOOL_INIT(Point)
+
+static void test_double_free(void) {
+	slotpool_t(Point) *pool = slotpool_create(Point, NULL, 4);
+
+	slotpool_handle_t a = slotpool_get(Point, pool);
+	slotpool_handle_t b = slotpool_get(Point, pool);
+	CHECK(a != SLOTPOOL_INVALID_HANDLE && b != SLOTPOOL_INVALID_HANDLE);
+
+	CHECK(slotpool_free(Point, pool, a));
+	CHECK(!slotpool_free(Point, pool, a));
+	CHECK(slotpool_resolve(Point, pool, a) == NULL);
+
+	// the free list is still right: every slot is handed out once
+	slotpool_handle_t handles[3];
+	for (int i = 0; i < 3; ++i) {
+		handles[i] = slotpool_get(Point, pool);
+		CHECK(handles[i] != SLOTPOOL_INVALID_HANDLE);
+		CHECK(slotpool_resolve(Point, pool, handles[i]) != NULL);
+	}
+	CHECK(slotpool_get(Point, pool) == SLOTPOOL_INVALID_HANDLE);
+	CHECK(SLOTPOOL_HANDLE_INDEX(handles[0]) != SLOTPOOL_HANDLE_INDEX(handles[1]));
+	CHECK(SLOTPOOL_HANDLE_INDEX(handles[0]) != SLOTPOOL_HANDLE_INDEX(handles[2]));
+	CHECK(SLOTPOOL_HANDLE_INDEX(handles[1]) != SLOTPOOL_HANDLE_INDEX(handles[2]));
+	CHECK(SLOTPOOL_HANDLE_INDEX(handles[0]) != SLOTPOOL_HANDLE_INDEX(b));
+
+	slotpool_destroy(Point, pool);
+}
+
+static void test_stale_handle_of(void) {
+	slotpool_t(Point) *pool = slotpool_create(Point, NULL, 4);
+
+	// slots never handed out have no handle
+	CHECK(slotpool_handle_of(Point, pool, &pool->items[3].data) == SLOTPOOL_INVALID_HANDLE);
+	CHECK(slotpool_resolve(Point, pool, SLOTPOOL_HANDLE(3, 0)) == NULL);
+
+	slotpool_handle_t handle = slotpool_get(Point, pool);
+	Point *point = slotpool_resolve(Point, pool, handle);
+	CHECK(point != NULL);
+	CHECK(slotpool_handle_of(Point, pool, point) == handle);
+
+	// a freed object has no handle, so it cannot be freed again through it
+	CHECK(slotpool_free(Point, pool, handle));
+	slotpool_handle_t stale = slotpool_handle_of(Point, pool, point);
+	CHECK(stale == SLOTPOOL_INVALID_HANDLE);
+	CHECK(!slotpool_free(Point, pool, stale));
+
+	// objects not from the pool have no handle
+	Point other;
+	CHECK(slotpool_handle_of(Point, pool, &other) == SLOTPOOL_INVALID_HANDLE);
+
+	slotpool_destroy(Point, pool);
+}
+
+static void test_generation_wrap(void) {
+	MemZone zone;
+	mem_zone_init(&zone, 1024);
+	slotpool_t(Point) *pool = slotpool_create(Point, &zone, 1);
+
+	// the generation wraps around many times without handing out an invalid handle
+	slotpool_handle_t first = slotpool_get(Point, pool);
+	CHECK(slotpool_free(Point, pool, first));
+	for (int i = 0; i < 0x30000; ++i) {
+		slotpool_handle_t handle = slotpool_get(Point, pool);
+		CHECK(handle != SLOTPOOL_INVALID_HANDLE);
+		CHECK(slotpool_free(Point, pool, handle));
+		CHECK(slotpool_resolve(Point, pool, handle) == NULL);
+	}
+
+	mem_zone_destroy(&zone);
+}
+
+static void test_max_items(void) {
+	// the last index is the end-of-list sentinel, so it can never be handed out
+	CHECK(slotpool_create(Point, NULL, SLOTPOOL_MAX_ITEMS) == NULL);
+
+	slotpool_t(Point) *pool = slotpool_create(Point, NULL, SLOTPOOL_MAX_ITEMS - 1);
+	CHECK(pool != NULL);
+	slotpool_destroy(Point, pool);
+}
+
+int main(void) {
+	test_double_free();
+	test_stale_handle_of();
+	test_generation_wrap();
+	test_max_items();
+	return test_result("test_slot_pool");
+}
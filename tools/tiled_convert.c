@@ -0,0 +1,303 @@
+/**
+ * @file tiled_convert.c
+ * @brief Host tool that converts Tiled maps (CSV or TMX) to the binary map format of 'tiled_bin.h'.
+ *
+ * Build with any host compiler, eg.: 'cc -O2 -o tiled_convert tools/tiled_convert.c'
+ *
+ * Usage:
+ *   tiled_convert -t 16x16 -o map.bin layer1.csv [layer2.csv ...]
+ *   tiled_convert [-t 16x16] -o map.bin map.tmx
+ *   tiled_convert -c 32x32 [-t 16x16] -o map.bin map.tmx
+ *
+ * CSV files use the same values as 'tiled_init' (-1 is an empty tile), one file per layer. TMX
+ * files must have their layers saved using the CSV encoding, and tiles are numbered from the
+ * 'firstgid' of the first tileset. The tile size is read from the TMX file if not informed.
+ *
+ * '-c WxH' writes the tiles in chunks of WxH tiles, used by 'tiled_stream_init'.
+ * '-b 2' writes 16-bit tile indexes, for games built with TILED_INDEX_16BIT (default is '-b 1').
+ */
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/tiled_bin.h"
+
+typedef struct {
+	int *tiles;
+	size_t count;
+	size_t capacity;
+} TileList;
+
+static void fail(const char *message, const char *detail) {
+	fprintf(stderr, "tiled_convert: %s%s%s\n", message, detail ? ": " : "", detail ? detail : "");
+	exit(1);
+}
+
+// Fails pointing to the byte 'offset' of the file 'path'.
+static void fail_at(const char *message, const char *path, size_t offset) {
+	fprintf(stderr, "tiled_convert: %s: %s (offset %zu)\n", message, path, offset);
+	exit(1);
+}
+
+static void tile_list_add(TileList *list, int tile) {
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity ? list->capacity * 2 : 1024;
+		list->tiles = realloc(list->tiles, list->capacity * sizeof(int));
+		if (!list->tiles)
+			fail("out of memory", NULL);
+	}
+	list->tiles[list->count++] = tile;
+}
+
+static char *read_file(const char *path) {
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		fail("could not open", path);
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *data = malloc(size + 1);
+	if (!data || fread(data, 1, size, file) != (size_t)size)
+		fail("could not read", path);
+	data[size] = '\0';
+
+	fclose(file);
+	return data;
+}
+
+/*
+ * Parses comma/line separated numbers from 'text' until 'end' (or the end of the string). 'file'
+ * is the start of the file 'path', used to point to invalid values.
+ * Returns the amount of tiles on the first row.
+ */
+static size_t parse_csv(const char *file, const char *path, const char *text, const char *end,
+						TileList *list) {
+	size_t width = 0;
+	size_t first = list->count;
+	while (*text && (!end || text < end)) {
+		if (*text == '-' || (*text >= '0' && *text <= '9')) {
+			char *next;
+			long tile = strtol(text, &next, 10);
+			if (next == text)
+				fail_at("invalid tile value", path, text - file);
+			tile_list_add(list, (int)tile);
+			text = next;
+		} else {
+			if (*text == '\n' && width == 0 && list->count > first)
+				width = list->count - first;
+			++text;
+		}
+	}
+	return width ? width : list->count - first;
+}
+
+// Reads the integer attribute 'name' from the tag that starts at 'tag'. Returns -1 if missing.
+static long tag_attribute(const char *tag, const char *name) {
+	const char *tag_end = strchr(tag, '>');
+	size_t name_length = strlen(name);
+	for (const char *c = tag; tag_end && c < tag_end; ++c) {
+		// attributes can be separated by any whitespace (eg.: one per line)
+		if (isspace((unsigned char)*c) && strncmp(c + 1, name, name_length) == 0 &&
+			c[1 + name_length] == '=')
+			return strtol(c + name_length + 3, NULL, 10);
+	}
+	return -1;
+}
+
+static void write_u16(FILE *file, uint16_t value) {
+	fputc(value >> 8, file);
+	fputc(value & 0xFF, file);
+}
+
+static void write_u32(FILE *file, uint32_t value) {
+	write_u16(file, value >> 16);
+	write_u16(file, value & 0xFFFF);
+}
+
+static void write_tile(FILE *file, TiledBinHeader *header, int tile) {
+	if (header->index_bytes == 2)
+		write_u16(file, tile & 0xFFFF);
+	else
+		fputc(tile & 0xFF, file);
+}
+
+static void write_map(const char *path, TiledBinHeader *header, TileList *tiles) {
+	FILE *file = fopen(path, "wb");
+	if (!file)
+		fail("could not create", path);
+
+	write_u32(file, header->magic);
+	write_u16(file, header->version);
+	write_u16(file, header->flags);
+	write_u16(file, header->width);
+	write_u16(file, header->height);
+	write_u16(file, header->tile_width);
+	write_u16(file, header->tile_height);
+	write_u16(file, header->layer_count);
+	fputc(header->index_bytes, file);
+	fputc(header->reserved, file);
+	write_u16(file, header->chunk_width);
+	write_u16(file, header->chunk_height);
+	fwrite(header->reserved2, 1, sizeof(header->reserved2), file);
+
+	if (!(header->flags & TILED_BIN_FLAG_CHUNKED)) {
+		for (size_t i = 0; i < tiles->count; ++i)
+			write_tile(file, header, tiles->tiles[i]);
+
+		fclose(file);
+		return;
+	}
+
+	size_t chunks_x = (header->width + header->chunk_width - 1) / header->chunk_width;
+	size_t chunks_y = (header->height + header->chunk_height - 1) / header->chunk_height;
+	for (size_t layer = 0; layer < header->layer_count; ++layer) {
+		int *layer_tiles = tiles->tiles + layer * header->width * header->height;
+		for (size_t chunk = 0; chunk < chunks_x * chunks_y; ++chunk) {
+			size_t start_x = (chunk % chunks_x) * header->chunk_width;
+			size_t start_y = (chunk / chunks_x) * header->chunk_height;
+			for (size_t y = start_y; y < start_y + header->chunk_height; ++y) {
+				for (size_t x = start_x; x < start_x + header->chunk_width; ++x) {
+					int tile = -1;  // padding outside of the map
+					if (x < header->width && y < header->height)
+						tile = layer_tiles[y * header->width + x];
+					write_tile(file, header, tile);
+				}
+			}
+		}
+	}
+
+	fclose(file);
+}
+
+int main(int argc, char **argv) {
+	const char *output = NULL;
+	int tile_width = -1, tile_height = -1;
+	int chunk_width = 0, chunk_height = 0;
+	int index_bytes = 1;
+	int first_input = argc;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+			output = argv[++i];
+		} else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			if (sscanf(argv[++i], "%dx%d", &tile_width, &tile_height) != 2)
+				fail("invalid tile size", argv[i]);
+		} else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+			if (sscanf(argv[++i], "%dx%d", &chunk_width, &chunk_height) != 2 ||
+				chunk_width <= 0 || chunk_height <= 0)
+				fail("invalid chunk size", argv[i]);
+		} else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+			index_bytes = atoi(argv[++i]);
+			if (index_bytes != 1 && index_bytes != 2)
+				fail("index size has to be 1 or 2", argv[i]);
+		} else {
+			first_input = i;
+			break;
+		}
+	}
+	if (!output || first_input == argc) {
+		fprintf(stderr, "usage: tiled_convert [-t WxH] [-c WxH] [-b 1|2] -o output.bin "
+						"input.tmx|layer.csv...\n");
+		return 1;
+	}
+
+	TiledBinHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = TILED_BIN_MAGIC;
+	header.version = TILED_BIN_VERSION;
+	header.index_bytes = index_bytes;
+
+	TileList tiles = {0};
+	const char *extension = strrchr(argv[first_input], '.');
+	if (extension && strcmp(extension, ".tmx") == 0) {
+		char *text = read_file(argv[first_input]);
+		const char *map = strstr(text, "<map");
+		if (!map)
+			fail("not a TMX file", argv[first_input]);
+
+		header.width = tag_attribute(map, "width");
+		header.height = tag_attribute(map, "height");
+		if (tile_width < 0) {
+			tile_width = tag_attribute(map, "tilewidth");
+			tile_height = tag_attribute(map, "tileheight");
+		}
+
+		const char *tileset = strstr(text, "<tileset");
+		long first_gid = tileset ? tag_attribute(tileset, "firstgid") : 1;
+
+		for (const char *data = strstr(text, "<data"); data; data = strstr(data + 1, "<data")) {
+			const char *data_start = strchr(data, '>');
+			if (!data_start)
+				fail_at("malformed TMX, '<data' tag is not closed", argv[first_input], data - text);
+			++data_start;
+			const char *encoding = strstr(data, "encoding=\"csv\"");
+			if (!encoding || encoding > data_start)
+				fail("only CSV encoded layers are supported", argv[first_input]);
+
+			size_t start = tiles.count;
+			parse_csv(text, argv[first_input], data_start, strstr(data_start, "</data>"), &tiles);
+			if (tiles.count - start != (size_t)header.width * header.height)
+				fail("layer size does not match the map size", argv[first_input]);
+
+			// Tiled uses 0 for empty tiles, and stores flipping on the upper bits
+			for (size_t i = start; i < tiles.count; ++i) {
+				unsigned gid = (unsigned)tiles.tiles[i] & 0x1FFFFFFF;
+				tiles.tiles[i] = gid == 0 ? -1 : (int)(gid - first_gid);
+			}
+			header.layer_count++;
+		}
+		free(text);
+	} else {
+		for (int i = first_input; i < argc; ++i) {
+			char *text = read_file(argv[i]);
+			size_t start = tiles.count;
+			size_t width = parse_csv(text, argv[i], text, NULL, &tiles);
+			size_t height = width ? (tiles.count - start) / width : 0;
+			free(text);
+			if (width && (tiles.count - start) % width != 0)
+				fail("rows have different sizes (tile count is not a multiple of the first row)",
+					 argv[i]);
+
+			if (header.layer_count == 0) {
+				header.width = width;
+				header.height = height;
+			} else if (width != header.width || height != header.height) {
+				fail("layer size does not match the first layer", argv[i]);
+			}
+			header.layer_count++;
+		}
+	}
+
+	if (tile_width <= 0 || tile_height <= 0)
+		fail("tile size is required (-t WxH)", NULL);
+	if (header.layer_count == 0 || header.width == 0 || header.height == 0)
+		fail("map is empty", argv[first_input]);
+
+	header.tile_width = tile_width;
+	header.tile_height = tile_height;
+	if (chunk_width > 0) {
+		header.flags |= TILED_BIN_FLAG_CHUNKED;
+		header.chunk_width = chunk_width;
+		header.chunk_height = chunk_height;
+	}
+
+	// the highest value is reserved for empty tiles
+	int max_tile = index_bytes == 2 ? 0xFFFE : 0xFE;
+	for (size_t i = 0; i < tiles.count; ++i) {
+		if (tiles.tiles[i] < -1)
+			fail("invalid tile index", argv[first_input]);
+		if (tiles.tiles[i] > max_tile)
+			fail(index_bytes == 2 ? "tile index too big" : "tile index too big, use '-b 2'",
+				 argv[first_input]);
+	}
+
+	write_map(output, &header, &tiles);
+	free(tiles.tiles);
+
+	printf("%s: %ux%u tiles, %u layer(s)\n", output, header.width, header.height,
+		   header.layer_count);
+	return 0;
+}